@@ -0,0 +1,73 @@
+#include <benchmark/benchmark.h>
+
+#include <functional>
+
+#include "any_delete.h"
+
+namespace
+{
+
+struct Object {
+  int value = 0;
+};
+
+template <typename D>
+void BM_create_destroy(benchmark::State &state)
+{
+  for (auto _ : state) {
+    Unique_ptr<void, D> up(new Object, [](void *p) {
+      delete static_cast<Object *>(p);
+    });
+    benchmark::DoNotOptimize(up.get());
+  }
+  state.counters["sizeof"] = sizeof(Unique_ptr<void, D>);
+}
+
+// Erases a deleter with state, as needed for e.g. a pool return
+template <typename D>
+void BM_stateful(benchmark::State &state)
+{
+  int pool = 0;
+  for (auto _ : state) {
+    int *p = &pool;
+    Unique_ptr<void, D> up(new Object, [p](void *ptr) {
+      ++*p;
+      delete static_cast<Object *>(ptr);
+    });
+    benchmark::DoNotOptimize(up.get());
+  }
+  benchmark::DoNotOptimize(pool);
+}
+
+// Not trivially copyable, so std::function stores it on the heap
+struct Pool_ref {
+  Pool_ref(int *count) : count(count) {}
+  Pool_ref(const Pool_ref &other) noexcept : count(other.count) {}
+
+  int *count;
+  int id = 0;
+};
+
+template <typename D>
+void BM_non_trivial(benchmark::State &state)
+{
+  int pool = 0;
+  for (auto _ : state) {
+    Pool_ref ref(&pool);
+    Unique_ptr<void, D> up(new Object, [ref](void *ptr) {
+      ++*ref.count;
+      delete static_cast<Object *>(ptr);
+    });
+    benchmark::DoNotOptimize(up.get());
+  }
+  benchmark::DoNotOptimize(pool);
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_create_destroy, Any_delete);
+BENCHMARK_TEMPLATE(BM_create_destroy, std::function<void(void *)>);
+BENCHMARK_TEMPLATE(BM_stateful, Any_delete);
+BENCHMARK_TEMPLATE(BM_stateful, std::function<void(void *)>);
+BENCHMARK_TEMPLATE(BM_non_trivial, Any_delete);
+BENCHMARK_TEMPLATE(BM_non_trivial, std::function<void(void *)>);
@@ -0,0 +1,102 @@
+#include <cstddef>
+#include <utility>
+
+#include "unique_ptr.h"
+
+// Compile-time benchmark: Unique_ptr workloads evaluated inside static_assert,
+// each of them BENCH_N in size. Build the bench_constexpr target to get the
+// time and memory report, the constant evaluation shows up under "constant
+// expression evaluation" (GCC) or "EvaluateAsConstantExpr" (Clang).
+
+#ifndef BENCH_N
+#define BENCH_N 1000
+#endif
+
+namespace
+{
+
+struct Node {
+  int value = 0;
+  Unique_ptr<Node> next;
+};
+
+struct Tree {
+  int value = 0;
+  Unique_ptr<Tree> left;
+  Unique_ptr<Tree> right;
+};
+
+// A list of n nodes, destroyed front to back so the evaluation does not
+// recurse n deep
+constexpr int chain(int n)
+{
+  Unique_ptr<Node> head;
+  for (int i = 0; i < n; ++i) {
+    auto node = make_unique<Node>();
+    node->value = i;
+    node->next = std::move(head);
+    head = std::move(node);
+  }
+
+  int sum = 0;
+  for (const Node *p = head.get(); p != nullptr; p = p->next.get()) {
+    sum += p->value;
+  }
+  while (head != nullptr) {
+    head = std::move(head->next);
+  }
+  return sum;
+}
+
+constexpr Unique_ptr<Tree> tree(int first, int last)
+{
+  if (first == last) {
+    return nullptr;
+  }
+  const int mid = first + (last - first) / 2;
+  auto node = make_unique<Tree>();
+  node->value = mid;
+  node->left = tree(first, mid);
+  node->right = tree(mid + 1, last);
+  return node;
+}
+
+constexpr int sum(const Tree *node)
+{
+  return node == nullptr
+             ? 0
+             : node->value + sum(node->left.get()) + sum(node->right.get());
+}
+
+// Many short-lived owners: make_unique, swap, release and reset
+constexpr int churn(int n)
+{
+  Unique_ptr<int> a;
+  Unique_ptr<int> b = make_unique<int>(0);
+  int sum = 0;
+  for (int i = 0; i < n; ++i) {
+    a.reset(new int(i));
+    swap(a, b);
+    int *raw = a.release();
+    sum += *raw + *b;
+    delete raw;
+    a = make_unique<int>(i);
+    b = std::move(a);
+  }
+  return sum;
+}
+
+constexpr int triangle(int n)
+{
+  return n * (n - 1) / 2;
+}
+
+} // namespace
+
+static_assert(chain(BENCH_N) == triangle(BENCH_N));
+static_assert(sum(tree(0, BENCH_N).get()) == triangle(BENCH_N));
+static_assert(churn(BENCH_N) == 2 * triangle(BENCH_N) - (BENCH_N - 1));
+
+int main()
+{
+}
@@ -0,0 +1,168 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "flat_serialize.h"
+#include "unique_ptr.h"
+
+// Saving and loading a balanced binary tree: flat_save / flat_view /
+// flat_load against a naive serializer that writes every field of every
+// node recursively and rebuilds the tree node by node.
+
+namespace
+{
+
+struct Node {
+  std::int64_t key;
+  double value;
+  Unique_ptr<Node> left;
+  Unique_ptr<Node> right;
+};
+
+} // namespace
+
+template <>
+struct Flat_layout<Node> {
+  static constexpr std::array children{&Node::left, &Node::right};
+};
+
+namespace
+{
+
+Unique_ptr<Node> build(std::int64_t first, std::int64_t last)
+{
+  if (first == last) {
+    return nullptr;
+  }
+  const std::int64_t mid = first + (last - first) / 2;
+  auto node = make_unique<Node>();
+  node->key = mid;
+  node->value = static_cast<double>(mid) / 2;
+  node->left = build(first, mid);
+  node->right = build(mid + 1, last);
+  return node;
+}
+
+template <typename T>
+void put(std::vector<std::byte> &out, const T &value)
+{
+  const auto *p = reinterpret_cast<const std::byte *>(&value);
+  out.insert(out.end(), p, p + sizeof(value));
+}
+
+template <typename T>
+T take(const std::byte *&in)
+{
+  T value;
+  std::memcpy(&value, in, sizeof(value));
+  in += sizeof(value);
+  return value;
+}
+
+void naive_save(const Node *node, std::vector<std::byte> &out)
+{
+  put(out, static_cast<std::uint8_t>(node != nullptr));
+  if (node != nullptr) {
+    put(out, node->key);
+    put(out, node->value);
+    naive_save(node->left.get(), out);
+    naive_save(node->right.get(), out);
+  }
+}
+
+Unique_ptr<Node> naive_load(const std::byte *&in)
+{
+  if (take<std::uint8_t>(in) == 0) {
+    return nullptr;
+  }
+  auto node = make_unique<Node>();
+  node->key = take<std::int64_t>(in);
+  node->value = take<double>(in);
+  node->left = naive_load(in);
+  node->right = naive_load(in);
+  return node;
+}
+
+std::int64_t sum(const Node *node)
+{
+  return node == nullptr
+             ? 0
+             : node->key + sum(node->left.get()) + sum(node->right.get());
+}
+
+std::int64_t sum(Flat_view<Node> node)
+{
+  return !node ? 0 : node->key + sum(node.child(0)) + sum(node.child(1));
+}
+
+void BM_naive_save(benchmark::State &state)
+{
+  const auto tree = build(0, state.range(0));
+  std::vector<std::byte> out;
+  for (auto _ : state) {
+    out.clear();
+    naive_save(tree.get(), out);
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<std::int64_t>(out.size()));
+}
+
+void BM_flat_save(benchmark::State &state)
+{
+  const auto tree = build(0, state.range(0));
+  Unique_buffer out;
+  for (auto _ : state) {
+    flat_save(tree.get(), out);
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<std::int64_t>(out.size()));
+}
+
+// Load and visit every node once
+void BM_naive_load(benchmark::State &state)
+{
+  std::vector<std::byte> data;
+  naive_save(build(0, state.range(0)).get(), data);
+  for (auto _ : state) {
+    const std::byte *in = data.data();
+    auto tree = naive_load(in);
+    benchmark::DoNotOptimize(sum(tree.get()));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_flat_view(benchmark::State &state)
+{
+  Unique_buffer data;
+  flat_save(build(0, state.range(0)).get(), data);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(sum(flat_view<Node>(data.span())));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_flat_load(benchmark::State &state)
+{
+  Unique_buffer data;
+  flat_save(build(0, state.range(0)).get(), data);
+  for (auto _ : state) {
+    auto tree = flat_load<Node>(data.span());
+    benchmark::DoNotOptimize(sum(tree.get()));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+} // namespace
+
+BENCHMARK(BM_naive_save)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK(BM_flat_save)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK(BM_naive_load)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK(BM_flat_view)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK(BM_flat_load)->Arg(1 << 10)->Arg(1 << 20);
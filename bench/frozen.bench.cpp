@@ -0,0 +1,95 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+
+#include "frozen.h"
+#include "unique_ptr.h"
+
+// Startup cost of a search tree of 1024 keys with 100 lookups: building it
+// with make_unique at run time, or reading one built at compile time and
+// frozen into static storage.
+
+namespace
+{
+
+struct Node {
+  int key = 0;
+  int value = 0;
+  Unique_ptr<Node> left;
+  Unique_ptr<Node> right;
+};
+
+constexpr int keys = 1024;
+constexpr int lookups = 100;
+
+constexpr Unique_ptr<Node> build(int first, int last)
+{
+  if (first == last) {
+    return nullptr;
+  }
+  const int mid = first + (last - first) / 2;
+  auto node = make_unique<Node>();
+  node->key = mid;
+  node->value = mid * 3;
+  node->left = build(first, mid);
+  node->right = build(mid + 1, last);
+  return node;
+}
+
+int find(const Node *node, int key)
+{
+  while (node != nullptr && node->key != key) {
+    node = (key < node->key ? node->left : node->right).get();
+  }
+  return node != nullptr ? node->value : -1;
+}
+
+template <typename View>
+int find(View node, int key)
+{
+  while (node && node->key != key) {
+    node = node.child(key < node->key ? &Node::left : &Node::right);
+  }
+  return node ? node->value : -1;
+}
+
+} // namespace
+
+template <>
+struct Flat_layout<Node> {
+  static constexpr std::array children{&Node::left, &Node::right};
+};
+
+namespace
+{
+
+constexpr auto frozen = freeze([] { return build(0, keys); });
+
+void BM_runtime(benchmark::State &state)
+{
+  for (auto _ : state) {
+    const auto owner = build(0, keys);
+    const Node *root = owner.get();
+    int sum = 0;
+    for (int i = 0; i < lookups; ++i) {
+      sum += find(root, i * 7 % keys);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+}
+
+void BM_frozen(benchmark::State &state)
+{
+  for (auto _ : state) {
+    int sum = 0;
+    for (int i = 0; i < lookups; ++i) {
+      sum += find(frozen.root(), i * 7 % keys);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+}
+
+} // namespace
+
+BENCHMARK(BM_runtime);
+BENCHMARK(BM_frozen);
@@ -0,0 +1,57 @@
+#include <cstddef>
+#include <utility>
+
+#include "unique_ptr.h"
+
+// Compile-time benchmark: stamps out BENCH_N distinct sets of Unique_ptr
+// specializations. Build the bench_instantiation target to get the front-end
+// time and memory report.
+
+#ifndef BENCH_N
+#define BENCH_N 1000
+#endif
+
+template <std::size_t N>
+struct Base {
+  virtual ~Base() = default;
+};
+
+template <std::size_t N>
+struct Derived : Base<N> {
+};
+
+// Deleter with a pointer type, exercises detail::Pointer
+template <std::size_t N>
+struct Pointer_delete {
+  using pointer = Base<N> *;
+
+  void operator()(pointer p) const
+  {
+    delete p;
+  }
+};
+
+template <std::size_t N>
+int instantiate()
+{
+  Unique_ptr<Derived<N>> d = make_unique<Derived<N>>();
+  Unique_ptr<Base<N>> b = std::move(d); // converting move construction
+  b = make_unique<Derived<N>>();        // converting move assignment
+
+  Unique_ptr<Base<N>, Pointer_delete<N>> p(new Base<N>);
+  Unique_ptr<Base<N>, Pointer_delete<N>> q;
+  swap(p, q);
+
+  return (b <=> d) < 0 || (b <=> nullptr) > 0 || p == q || q == nullptr;
+}
+
+template <std::size_t... I>
+int instantiate_all(std::index_sequence<I...>)
+{
+  return (instantiate<I>() + ...);
+}
+
+int main()
+{
+  return instantiate_all(std::make_index_sequence<BENCH_N>{});
+}
@@ -0,0 +1,123 @@
+#include <benchmark/benchmark.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "io_buffer_pool.h"
+
+// O_DIRECT reads from a local file, with buffers from an Io_buffer_pool or
+// from posix_memalign and free per request. Falls back to buffered reads if
+// the file system does not support O_DIRECT (e.g. tmpfs), see the label.
+
+namespace
+{
+
+constexpr std::size_t file_size = 64 << 20;
+constexpr const char *file_name = "io_buffer_pool.bench.data";
+
+struct File {
+  File()
+  {
+    int out = ::open(file_name, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    std::vector<char> chunk(1 << 20, 'x');
+    for (std::size_t n = 0; n < file_size; n += chunk.size()) {
+      if (::write(out, chunk.data(), chunk.size()) < 0) {
+        break;
+      }
+    }
+    ::fsync(out);
+    ::close(out);
+
+    fd = ::open(file_name, O_RDONLY | O_DIRECT);
+    if (fd < 0) {
+      direct = false;
+      fd = ::open(file_name, O_RDONLY);
+    }
+  }
+
+  ~File()
+  {
+    ::close(fd);
+    ::unlink(file_name);
+  }
+
+  int fd;
+  bool direct = true;
+};
+
+File &file()
+{
+  static File f;
+  return f;
+}
+
+struct Pooled {
+  static Io_buffer acquire(std::size_t size)
+  {
+    return Io_buffer_pool::shared().acquire(size);
+  }
+};
+
+struct Unpooled {
+  static Io_buffer acquire(std::size_t size)
+  {
+    void *ptr = nullptr;
+    if (::posix_memalign(&ptr, Io_buffer_pool::alignment, size) != 0) {
+      return {};
+    }
+    return Io_buffer(static_cast<std::byte *>(ptr),
+                     Pool_return_delete(nullptr, size));
+  }
+};
+
+template <typename Source>
+void BM_sequential(benchmark::State &state)
+{
+  const auto block = static_cast<std::size_t>(state.range(0));
+  File &f = file();
+  Io_buffer_pool::shared().prefault(block, 4);
+
+  off_t offset = 0;
+  for (auto _ : state) {
+    Io_buffer buf = Source::acquire(block);
+    benchmark::DoNotOptimize(::pread(f.fd, buf.get(), block, offset));
+    offset = (offset + static_cast<off_t>(block)) % file_size;
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+  state.SetLabel(f.direct ? "O_DIRECT" : "buffered");
+}
+
+template <typename Source>
+void BM_random(benchmark::State &state)
+{
+  const auto block = static_cast<std::size_t>(state.range(0));
+  File &f = file();
+  Io_buffer_pool::shared().prefault(block, 4);
+
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<std::size_t> pick(0, file_size / block - 1);
+  for (auto _ : state) {
+    Io_buffer buf = Source::acquire(block);
+    const auto offset = static_cast<off_t>(pick(rng) * block);
+    benchmark::DoNotOptimize(::pread(f.fd, buf.get(), block, offset));
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+  state.SetLabel(f.direct ? "O_DIRECT" : "buffered");
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_sequential, Pooled)
+    ->Arg(64 << 10)
+    ->Arg(1 << 20)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_sequential, Unpooled)
+    ->Arg(64 << 10)
+    ->Arg(1 << 20)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_random, Pooled)->Arg(4 << 10)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_random, Unpooled)->Arg(4 << 10)->UseRealTime();
@@ -0,0 +1,161 @@
+#include <benchmark/benchmark.h>
+
+#include <malloc.h>
+
+#include <cstdint>
+#include <list>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "lru_cache.h"
+#include "unique_ptr.h"
+
+// Lru_cache against the usual unordered_map of std::list iterators, both
+// holding Unique_ptr<V> values: heap bytes per entry for the cache structure
+// itself (the values are allocated before measuring starts), and find
+// throughput for hits and for misses that insert and evict.
+
+namespace
+{
+
+// Heap bytes in use, including malloc's own overhead
+std::size_t heap_in_use()
+{
+  const struct mallinfo2 info = ::mallinfo2();
+  return info.uordblks + info.hblkhd;
+}
+
+} // namespace
+
+namespace
+{
+
+using Key = std::uint64_t;
+
+struct Value {
+  std::uint64_t data[4];
+};
+
+class Std_lru
+{
+public:
+  explicit Std_lru(std::size_t capacity) : capacity_(capacity)
+  {
+    map_.reserve(capacity);
+  }
+
+  Value *find(Key key)
+  {
+    auto it = map_.find(key);
+    if (it == map_.end()) {
+      return nullptr;
+    }
+    list_.splice(list_.begin(), list_, it->second);
+    return it->second->second.get();
+  }
+
+  Unique_ptr<Value> insert(Key key, Unique_ptr<Value> value)
+  {
+    Unique_ptr<Value> evicted;
+    if (map_.size() == capacity_) {
+      map_.erase(list_.back().first);
+      evicted = std::move(list_.back().second);
+      list_.pop_back();
+    }
+    list_.emplace_front(key, std::move(value));
+    map_.emplace(key, list_.begin());
+    return evicted;
+  }
+
+private:
+  using List = std::list<std::pair<Key, Unique_ptr<Value>>>;
+
+  std::size_t capacity_;
+  List list_;
+  std::unordered_map<Key, List::iterator> map_;
+};
+
+struct Lru {
+  explicit Lru(std::size_t capacity) : cache(capacity) {}
+
+  Value *find(Key key)
+  {
+    return cache.find(key);
+  }
+
+  Unique_ptr<Value> insert(Key key, Unique_ptr<Value> value)
+  {
+    return cache.insert(key, std::move(value)).value;
+  }
+
+  Lru_cache<Key, Value> cache;
+};
+
+template <typename Cache>
+void BM_bytes_per_entry(benchmark::State &state)
+{
+  const auto n = static_cast<std::size_t>(state.range(0));
+  std::size_t bytes = 0;
+  for (auto _ : state) {
+    std::vector<Unique_ptr<Value>> values;
+    for (std::size_t i = 0; i < n; ++i) {
+      values.push_back(make_unique<Value>());
+    }
+    const std::size_t before = heap_in_use();
+    Cache cache(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      cache.insert(i, std::move(values[i]));
+    }
+    bytes = heap_in_use() - before;
+  }
+  state.counters["bytes/entry"] =
+      static_cast<double>(bytes) / static_cast<double>(n);
+}
+
+template <typename Cache>
+void BM_hit(benchmark::State &state)
+{
+  const auto n = static_cast<std::size_t>(state.range(0));
+  Cache cache(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    cache.insert(i, make_unique<Value>());
+  }
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<Key> pick(0, n - 1);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cache.find(pick(rng)));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Every lookup misses, the value is loaded and evicts the oldest entry.
+// The evicted owner is reused for the next insert so that only the cache
+// structure is measured.
+template <typename Cache>
+void BM_miss(benchmark::State &state)
+{
+  const auto n = static_cast<std::size_t>(state.range(0));
+  Cache cache(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    cache.insert(i, make_unique<Value>());
+  }
+  Key next = n;
+  Unique_ptr<Value> spare = make_unique<Value>();
+  for (auto _ : state) {
+    if (cache.find(next) == nullptr) {
+      spare = cache.insert(next, std::move(spare));
+    }
+    ++next;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_bytes_per_entry, Lru)->Arg(1 << 16)->Iterations(1);
+BENCHMARK_TEMPLATE(BM_bytes_per_entry, Std_lru)->Arg(1 << 16)->Iterations(1);
+BENCHMARK_TEMPLATE(BM_hit, Lru)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_hit, Std_lru)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_miss, Lru)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_miss, Std_lru)->Arg(1 << 10)->Arg(1 << 20);
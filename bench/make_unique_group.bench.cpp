@@ -0,0 +1,81 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "make_unique_group.h"
+
+namespace
+{
+
+struct Stats {
+  long hits = 1;
+  long misses = 2;
+};
+
+struct Payload {
+  char data[48] = {};
+};
+
+// Record with owned members, allocated either as one group or one by one
+template <template <typename> typename Owner>
+struct Record {
+  Record() noexcept = default;
+
+  Record(Owner<Stats> stats, Owner<Payload> payload, int id)
+      : stats(std::move(stats)), payload(std::move(payload)), id(id)
+  {
+  }
+
+  Owner<Stats> stats;
+  Owner<Payload> payload;
+  int id = 0;
+};
+
+template <typename T>
+using Plain_ptr = Unique_ptr<T>;
+
+using Group_record = Record<Unique_group_ptr>;
+using Plain_record = Record<Plain_ptr>;
+
+Unique_group_ptr<Group_record> make_group(int id)
+{
+  return make_unique_group<Group_record, Stats, Payload>(id);
+}
+
+Unique_ptr<Plain_record> make_plain(int id)
+{
+  return make_unique<Plain_record>(make_unique<Stats>(),
+                                   make_unique<Payload>(), id);
+}
+
+template <auto Make>
+void BM_construct(benchmark::State &state)
+{
+  for (auto _ : state) {
+    auto record = Make(1);
+    benchmark::DoNotOptimize(record.get());
+  }
+}
+
+template <auto Make>
+void BM_traverse(benchmark::State &state)
+{
+  std::vector<decltype(Make(0))> records;
+  for (int i = 0; i < 10000; ++i) {
+    records.push_back(Make(i));
+  }
+  for (auto _ : state) {
+    long sum = 0;
+    for (const auto &r : records) {
+      sum += r->id + r->stats->hits + r->payload->data[0];
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_construct, make_group);
+BENCHMARK_TEMPLATE(BM_construct, make_plain);
+BENCHMARK_TEMPLATE(BM_traverse, make_group);
+BENCHMARK_TEMPLATE(BM_traverse, make_plain);
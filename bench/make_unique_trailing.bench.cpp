@@ -0,0 +1,81 @@
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <vector>
+
+#include "make_unique_trailing.h"
+
+namespace
+{
+
+struct Message {
+  int type = 1;
+  int flags = 0;
+};
+
+// Two-allocation layout: the payload lives in its own buffer
+struct Split_message {
+  int type = 1;
+  int flags = 0;
+  std::vector<char> payload;
+};
+
+void BM_trailing_create(benchmark::State &state)
+{
+  const auto n = static_cast<std::size_t>(state.range(0));
+  for (auto _ : state) {
+    auto up = make_unique_trailing_for_overwrite<Message, char>(n);
+    std::memset(trailing(up).data(), 'x', n);
+    benchmark::DoNotOptimize(up.get());
+  }
+}
+
+void BM_split_create(benchmark::State &state)
+{
+  const auto n = static_cast<std::size_t>(state.range(0));
+  for (auto _ : state) {
+    auto up = make_unique<Split_message>();
+    up->payload.resize(n);
+    std::memset(up->payload.data(), 'x', n);
+    benchmark::DoNotOptimize(up.get());
+  }
+}
+
+// Reads the header and first payload byte of many live messages
+void BM_trailing_traverse(benchmark::State &state)
+{
+  std::vector<Unique_trailing_ptr<Message, char>> messages;
+  for (int i = 0; i < 10000; ++i) {
+    messages.push_back(make_unique_trailing<Message, char>(64));
+  }
+  for (auto _ : state) {
+    long sum = 0;
+    for (const auto &m : messages) {
+      sum += m->type + trailing(m)[0];
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+}
+
+void BM_split_traverse(benchmark::State &state)
+{
+  std::vector<Unique_ptr<Split_message>> messages;
+  for (int i = 0; i < 10000; ++i) {
+    messages.push_back(make_unique<Split_message>());
+    messages.back()->payload.resize(64);
+  }
+  for (auto _ : state) {
+    long sum = 0;
+    for (const auto &m : messages) {
+      sum += m->type + m->payload[0];
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+}
+
+} // namespace
+
+BENCHMARK(BM_trailing_create)->Arg(16)->Arg(256)->Arg(4096);
+BENCHMARK(BM_split_create)->Arg(16)->Arg(256)->Arg(4096);
+BENCHMARK(BM_trailing_traverse);
+BENCHMARK(BM_split_traverse);
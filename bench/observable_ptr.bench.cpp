@@ -0,0 +1,100 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+
+#include "observable_ptr.h"
+
+// Unique_observable_ptr against Unique_ptr and shared_ptr/weak_ptr: owners
+// that are never observed, creating an observer, and checking it.
+
+namespace
+{
+
+struct Object {
+  int value = 0;
+};
+
+struct Unique {
+  using Owner = Unique_ptr<Object>;
+
+  static Owner make()
+  {
+    return make_unique<Object>();
+  }
+};
+
+struct Observable {
+  using Owner = Unique_observable_ptr<Object>;
+  using Observer = Weak_observer<Object>;
+
+  static Owner make()
+  {
+    return make_unique_observable<Object>();
+  }
+};
+
+struct Shared {
+  using Owner = std::shared_ptr<Object>;
+  using Observer = std::weak_ptr<Object>;
+
+  static Owner make()
+  {
+    return std::make_shared<Object>();
+  }
+};
+
+// Created, moved twice and destroyed without ever being observed
+template <typename Kind>
+void BM_unobserved(benchmark::State &state)
+{
+  for (auto _ : state) {
+    typename Kind::Owner owner = Kind::make();
+    typename Kind::Owner moved = std::move(owner);
+    owner = std::move(moved);
+    benchmark::DoNotOptimize(owner.get());
+  }
+  state.counters["sizeof"] = sizeof(typename Kind::Owner);
+}
+
+// Created with one observer that outlives the owner
+template <typename Kind>
+void BM_observed(benchmark::State &state)
+{
+  for (auto _ : state) {
+    typename Kind::Owner owner = Kind::make();
+    typename Kind::Observer observer(owner);
+    owner.reset();
+    benchmark::DoNotOptimize(observer.expired());
+  }
+}
+
+template <typename Kind>
+void BM_lock(benchmark::State &state)
+{
+  typename Kind::Owner owner = Kind::make();
+  typename Kind::Observer observer(owner);
+  for (auto _ : state) {
+    auto locked = observer.lock();
+    benchmark::DoNotOptimize(locked->value);
+  }
+}
+
+void BM_get(benchmark::State &state)
+{
+  Observable::Owner owner = Observable::make();
+  Observable::Observer observer(owner);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(observer.get());
+  }
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_unobserved, Unique);
+BENCHMARK_TEMPLATE(BM_unobserved, Observable);
+BENCHMARK_TEMPLATE(BM_unobserved, Shared);
+BENCHMARK_TEMPLATE(BM_observed, Observable);
+BENCHMARK_TEMPLATE(BM_observed, Shared);
+BENCHMARK_TEMPLATE(BM_lock, Observable);
+BENCHMARK_TEMPLATE(BM_lock, Shared);
+BENCHMARK(BM_get);
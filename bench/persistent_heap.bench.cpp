@@ -0,0 +1,126 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "persistent_heap.h"
+#include "unique_ptr.h"
+
+// Time from startup to the first lookups in a binary search tree index:
+// rebuilding it on the heap from the source records, or reopening a
+// persistent heap that already holds it. The file is in the page cache, so
+// this is the warm restart case.
+
+namespace
+{
+
+constexpr const char *file_name = "persistent_heap.bench.heap";
+constexpr int lookups = 1000;
+
+std::uint64_t key_of(std::uint64_t i)
+{
+  return i * 0x9e3779b97f4a7c15;
+}
+
+template <template <typename> typename Owner>
+struct Tree_node {
+  std::uint64_t key;
+  std::uint64_t value;
+  Owner<Tree_node> left;
+  Owner<Tree_node> right;
+};
+
+template <typename T>
+using Heap_owner = Unique_ptr<T>;
+
+using Heap_node = Tree_node<Heap_owner>;
+using Persistent_node = Tree_node<Unique_persistent_ptr>;
+
+std::vector<std::uint64_t> sorted_keys(std::size_t n)
+{
+  std::vector<std::uint64_t> keys(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    keys[i] = key_of(i);
+  }
+  std::sort(keys.begin(), keys.end());
+  return keys;
+}
+
+template <typename Owner, typename Make>
+Owner build(const std::uint64_t *first, const std::uint64_t *last, Make make)
+{
+  if (first == last) {
+    return Owner(nullptr);
+  }
+  const std::uint64_t *mid = first + (last - first) / 2;
+  Owner node = make();
+  node->key = *mid;
+  node->value = *mid / 2;
+  node->left = build<Owner>(first, mid, make);
+  node->right = build<Owner>(mid + 1, last, make);
+  return node;
+}
+
+template <typename Node>
+std::uint64_t lookup(const Node *root, std::size_t n)
+{
+  std::uint64_t sum = 0;
+  for (int i = 0; i < lookups; ++i) {
+    const std::uint64_t key = key_of(static_cast<std::uint64_t>(i) * 7919 % n);
+    for (const Node *p = root; p != nullptr;) {
+      if (key == p->key) {
+        sum += p->value;
+        break;
+      }
+      p = std::to_address((key < p->key ? p->left : p->right).get());
+    }
+  }
+  return sum;
+}
+
+void BM_rebuild(benchmark::State &state)
+{
+  const auto n = static_cast<std::size_t>(state.range(0));
+  for (auto _ : state) {
+    const std::vector<std::uint64_t> keys = sorted_keys(n);
+    auto root = build<Unique_ptr<Heap_node>>(
+        keys.data(), keys.data() + n, [] { return make_unique<Heap_node>(); });
+    benchmark::DoNotOptimize(lookup(root.get(), n));
+
+    state.PauseTiming();
+    root.reset();
+    state.ResumeTiming();
+  }
+}
+
+void BM_reopen(benchmark::State &state)
+{
+  const auto n = static_cast<std::size_t>(state.range(0));
+  std::remove(file_name);
+  {
+    // A 64 byte block per node, a page for each header
+    Persistent_heap heap = Persistent_heap::open(file_name, n * 64 + 8192);
+    const std::vector<std::uint64_t> keys = sorted_keys(n);
+    auto root = build<Unique_persistent_ptr<Persistent_node>>(
+        keys.data(), keys.data() + n,
+        [&] { return make_unique_persistent<Persistent_node>(heap); });
+    heap.publish(root);
+  }
+
+  for (auto _ : state) {
+    Persistent_heap heap = Persistent_heap::open(file_name, 0);
+    benchmark::DoNotOptimize(lookup(heap.root<Persistent_node>(), n));
+  }
+  std::remove(file_name);
+}
+
+} // namespace
+
+BENCHMARK(BM_rebuild)
+    ->Arg(1 << 16)
+    ->Arg(1 << 20)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_reopen)->Arg(1 << 16)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,74 @@
+#include <benchmark/benchmark.h>
+
+#include <malloc.h>
+
+#include <memory>
+#include <vector>
+
+#include "shareable_ptr.h"
+
+// Creating a unique owner and promoting it to a shared_ptr: share() of a
+// make_unique_shareable object against shared_ptr(std::move(up)) of a
+// make_unique one, with make_shared as the lower bound. Also reports the heap
+// bytes per object.
+
+namespace
+{
+
+struct Object {
+  long value[4] = {};
+};
+
+// Heap bytes in use, including malloc's own overhead
+std::size_t heap_in_use()
+{
+  const struct mallinfo2 info = ::mallinfo2();
+  return info.uordblks + info.hblkhd;
+}
+
+struct Promote {
+  static std::shared_ptr<Object> make()
+  {
+    Unique_ptr<Object> up = make_unique<Object>();
+    return std::shared_ptr<Object>(up.release());
+  }
+};
+
+struct Share {
+  static std::shared_ptr<Object> make()
+  {
+    return share(make_unique_shareable<Object>());
+  }
+};
+
+struct Make_shared {
+  static std::shared_ptr<Object> make()
+  {
+    return std::make_shared<Object>();
+  }
+};
+
+template <typename Kind>
+void BM_make_and_share(benchmark::State &state)
+{
+  for (auto _ : state) {
+    std::shared_ptr<Object> sp = Kind::make();
+    benchmark::DoNotOptimize(sp.get());
+  }
+  // Enough live objects that malloc's caches don't hide them
+  constexpr std::size_t n = 4096;
+  std::vector<std::shared_ptr<Object>> live;
+  live.reserve(n);
+  const std::size_t before = heap_in_use();
+  for (std::size_t i = 0; i < n; ++i) {
+    live.push_back(Kind::make());
+  }
+  state.counters["bytes/object"] =
+      static_cast<double>(heap_in_use() - before) / n;
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_make_and_share, Promote);
+BENCHMARK_TEMPLATE(BM_make_and_share, Share);
+BENCHMARK_TEMPLATE(BM_make_and_share, Make_shared);
@@ -0,0 +1,264 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "shm_segment.h"
+#include "unique_ptr.h"
+
+// Hands a linked list from this process to a forked child, which sums it and
+// replies with the result. Either the list is built in a shared memory
+// segment and the child walks it through its own mapping, or the list is
+// built on the heap, serialized over a pipe and rebuilt by the child.
+//
+// The second argument selects whether the parent builds and frees the list
+// in every iteration, or shares one list built up front.
+
+namespace
+{
+
+struct Shm_node {
+  explicit Shm_node(std::int64_t v) : value(v) {}
+
+  std::int64_t value;
+  Unique_shm_ptr<Shm_node> next;
+};
+
+struct Heap_node {
+  explicit Heap_node(std::int64_t v) : value(v) {}
+
+  std::int64_t value;
+  Unique_ptr<Heap_node> next;
+};
+
+bool read_all(int fd, void *data, std::size_t size)
+{
+  auto *p = static_cast<char *>(data);
+  while (size != 0) {
+    const ssize_t n = ::read(fd, p, size);
+    if (n <= 0) {
+      return false;
+    }
+    p += n;
+    size -= static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+bool write_all(int fd, const void *data, std::size_t size)
+{
+  const auto *p = static_cast<const char *>(data);
+  while (size != 0) {
+    const ssize_t n = ::write(fd, p, size);
+    if (n <= 0) {
+      return false;
+    }
+    p += n;
+    size -= static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+// A child process serving requests until the request pipe is closed
+class Child
+{
+public:
+  template <typename Serve>
+  explicit Child(Serve serve)
+  {
+    int request[2];
+    int reply[2];
+    if (::pipe(request) != 0 || ::pipe(reply) != 0) {
+      std::abort();
+    }
+    pid_ = ::fork();
+    if (pid_ == 0) {
+      ::close(request[1]);
+      ::close(reply[0]);
+      serve(request[0], reply[1]);
+      ::_exit(0);
+    }
+    ::close(request[0]);
+    ::close(reply[1]);
+    request_ = request[1];
+    reply_ = reply[0];
+  }
+
+  ~Child()
+  {
+    ::close(request_);
+    ::close(reply_);
+    ::waitpid(pid_, nullptr, 0);
+  }
+
+  int request() const
+  {
+    return request_;
+  }
+
+  int reply() const
+  {
+    return reply_;
+  }
+
+private:
+  pid_t pid_;
+  int request_;
+  int reply_;
+};
+
+void BM_shm(benchmark::State &state)
+{
+  const auto n = static_cast<std::int64_t>(state.range(0));
+  const std::string name = "/unique_ptr_bench_" + std::to_string(::getpid());
+  Shm_segment segment = Shm_segment::create(
+      name.c_str(), static_cast<std::size_t>(n) * 64 + 4096);
+
+  Child child([&](int in, int out) {
+    // Its own mapping, at a different address than the parent's
+    Shm_segment mapped = Shm_segment::open(name.c_str());
+    char go;
+    while (read_all(in, &go, 1)) {
+      std::int64_t sum = 0;
+      for (Shm_node *p = mapped.root<Shm_node>(); p != nullptr;
+           p = p->next.get().get()) {
+        sum += p->value;
+      }
+      write_all(out, &sum, sizeof(sum));
+    }
+  });
+
+  const bool rebuild = state.range(1) != 0;
+  const auto build = [&] {
+    Unique_shm_ptr<Shm_node> head;
+    for (std::int64_t i = n; i-- > 0;) {
+      auto node = make_unique_shm<Shm_node>(segment, i);
+      node->next = std::move(head);
+      head = std::move(node);
+    }
+    segment.set_root(head.get().get());
+    return head;
+  };
+  const auto destroy = [&](Unique_shm_ptr<Shm_node> head) {
+    segment.set_root(nullptr);
+    // Iteratively, a long list would overflow the stack
+    while (head != nullptr) {
+      head = std::move(head->next);
+    }
+  };
+
+  Unique_shm_ptr<Shm_node> shared = build();
+  for (auto _ : state) {
+    Unique_shm_ptr<Shm_node> head;
+    if (rebuild) {
+      destroy(std::move(shared));
+      head = build();
+    }
+
+    const char go = 1;
+    std::int64_t sum;
+    write_all(child.request(), &go, 1);
+    read_all(child.reply(), &sum, sizeof(sum));
+    benchmark::DoNotOptimize(sum);
+
+    if (rebuild) {
+      destroy(std::move(head));
+    }
+  }
+  destroy(std::move(shared));
+  Shm_segment::remove(name.c_str());
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+void BM_pipe(benchmark::State &state)
+{
+  const auto n = static_cast<std::int64_t>(state.range(0));
+
+  Child child([](int in, int out) {
+    std::int64_t count;
+    std::vector<std::int64_t> values;
+    while (read_all(in, &count, sizeof(count))) {
+      values.resize(static_cast<std::size_t>(count));
+      read_all(in, values.data(), values.size() * sizeof(std::int64_t));
+      Unique_ptr<Heap_node> head;
+      for (std::size_t i = values.size(); i-- > 0;) {
+        auto node = make_unique<Heap_node>(values[i]);
+        node->next = std::move(head);
+        head = std::move(node);
+      }
+
+      std::int64_t sum = 0;
+      for (Heap_node *p = head.get(); p != nullptr; p = p->next.get()) {
+        sum += p->value;
+      }
+      write_all(out, &sum, sizeof(sum));
+      while (head != nullptr) {
+        head = std::move(head->next);
+      }
+    }
+  });
+
+  const bool rebuild = state.range(1) != 0;
+  const auto build = [&] {
+    Unique_ptr<Heap_node> head;
+    for (std::int64_t i = n; i-- > 0;) {
+      auto node = make_unique<Heap_node>(i);
+      node->next = std::move(head);
+      head = std::move(node);
+    }
+    return head;
+  };
+  const auto destroy = [](Unique_ptr<Heap_node> head) {
+    while (head != nullptr) {
+      head = std::move(head->next);
+    }
+  };
+
+  Unique_ptr<Heap_node> shared = build();
+  std::vector<std::int64_t> values;
+  for (auto _ : state) {
+    Unique_ptr<Heap_node> head;
+    if (rebuild) {
+      destroy(std::move(shared));
+      head = build();
+    } else {
+      head = std::move(shared);
+    }
+
+    values.clear();
+    for (Heap_node *p = head.get(); p != nullptr; p = p->next.get()) {
+      values.push_back(p->value);
+    }
+    write_all(child.request(), &n, sizeof(n));
+    write_all(child.request(), values.data(),
+              values.size() * sizeof(std::int64_t));
+    std::int64_t sum;
+    read_all(child.reply(), &sum, sizeof(sum));
+    benchmark::DoNotOptimize(sum);
+
+    if (rebuild) {
+      destroy(std::move(head));
+    } else {
+      shared = std::move(head);
+    }
+  }
+  destroy(std::move(shared));
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+} // namespace
+
+BENCHMARK(BM_shm)
+    ->ArgsProduct({{1 << 10, 1 << 16}, {0, 1}})
+    ->ArgNames({"n", "rebuild"})
+    ->UseRealTime();
+BENCHMARK(BM_pipe)
+    ->ArgsProduct({{1 << 10, 1 << 16}, {0, 1}})
+    ->ArgNames({"n", "rebuild"})
+    ->UseRealTime();
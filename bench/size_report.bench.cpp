@@ -0,0 +1,77 @@
+#include <cstddef>
+#include <utility>
+
+#include "erased_delete.h"
+
+// Code size stress TU for the size_report target: BENCH_N deleter types for
+// the same element type, each owner passed through the same generic code.
+// Built once with every deleter stamping out its own Unique_ptr
+// specialization and once with ERASED defined, where all of them share
+// Unique_ptr<Object, Erased_delete<Object>>.
+
+#ifndef BENCH_N
+#define BENCH_N 100
+#endif
+
+namespace
+{
+
+struct Object {
+  long value;
+};
+
+long destroyed = 0;
+long largest = 0;
+
+// Deleter with some per-type work, like a pool return or stats update
+template <std::size_t N>
+struct Stats_delete {
+  void operator()(Object *p) const
+  {
+    destroyed += N;
+    if (p->value > largest) {
+      largest = p->value;
+    }
+    delete p;
+  }
+};
+
+template <std::size_t N>
+#ifdef ERASED
+using Owner = Unique_ptr<Object, Erased_delete<Object>>;
+#else
+using Owner = Unique_ptr<Object, Stats_delete<N>>;
+#endif
+
+// Generic code instantiated once per distinct owner type
+template <typename Owner>
+[[gnu::noinline]] long recycle(Owner &a, long value)
+{
+  Owner b(std::move(a));
+  a.reset(new Object{value});
+  a = std::move(b);
+  swap(a, b);
+  b.reset();
+  return a ? a->value : 0;
+}
+
+template <std::size_t N>
+long churn()
+{
+  Owner<N> a(new Object{N}, Stats_delete<N>());
+  return recycle(a, N + 1);
+}
+
+template <std::size_t... I>
+long churn_all(std::index_sequence<I...>)
+{
+  return (churn<I>() + ...);
+}
+
+} // namespace
+
+int main()
+{
+  return static_cast<int>(churn_all(std::make_index_sequence<BENCH_N>{}) +
+                          destroyed + largest);
+}
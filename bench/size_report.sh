@@ -0,0 +1,54 @@
+#!/bin/sh
+# Usage: size_report.sh <binary>...
+#
+# Prints the section sizes of each binary and the bytes attributed to each
+# Unique_ptr specialization, i.e. the summed sizes of all symbols whose
+# demangled name contains it. Remaining symbols are listed by name. Only
+# members the compiler did not inline show up, so build at -Os for the
+# clearest picture.
+
+for bin in "$@"; do
+  echo "== $bin"
+  size "$bin"
+  nm -C -S --size-sort "$bin" | awk '
+    function hex(s,    i, n, c) {
+      n = 0
+      s = tolower(s)
+      for (i = 1; i <= length(s); i++) {
+        c = index("0123456789abcdef", substr(s, i, 1)) - 1
+        n = n * 16 + c
+      }
+      return n
+    }
+    # Returns the Unique_ptr<...> template-id in name, or "" if there is none
+    function specialization(name,    start, i, depth, c) {
+      start = index(name, "Unique_ptr<")
+      if (start == 0)
+        return ""
+      depth = 0
+      for (i = start + 10; i <= length(name); i++) {
+        c = substr(name, i, 1)
+        if (c == "<")
+          depth++
+        else if (c == ">" && --depth == 0)
+          return substr(name, start, i - start + 1)
+      }
+      return ""
+    }
+    # Constructor and destructor variants are aliases, count each address once
+    NF >= 4 && $3 ~ /^[tTwW]$/ && !seen[$1]++ {
+      name = $0
+      sub(/^[^ ]+ [^ ]+ [^ ]+ /, "", name)
+      key = specialization(name)
+      if (key == "")
+        key = "(other) " name
+      bytes[key] += hex($2)
+      total += hex($2)
+    }
+    END {
+      for (key in bytes)
+        printf "%8d  %s\n", bytes[key], key | "sort -rn"
+      close("sort -rn")
+      printf "%8d  total code\n", total
+    }'
+done
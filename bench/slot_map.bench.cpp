@@ -0,0 +1,124 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "slot_map.h"
+#include "unique_ptr.h"
+
+// Entities in a Slot_map against a vector<Unique_ptr<T>>. Both are filled
+// with twice the entities and half of them erased at random, so the heap
+// objects are as scattered as after some churn.
+
+namespace
+{
+
+struct Entity {
+  float x = 0;
+  float y = 0;
+  float vx = 1;
+  float vy = 2;
+};
+
+struct Slots {
+  explicit Slots(std::size_t n)
+  {
+    std::vector<Unique_slot<Entity>> all;
+    for (std::size_t i = 0; i < 2 * n; ++i) {
+      all.push_back(map.emplace());
+    }
+    std::shuffle(all.begin(), all.end(), std::mt19937(42));
+    all.resize(n);
+    owners = std::move(all);
+  }
+
+  Slot_map<Entity> map;
+  std::vector<Unique_slot<Entity>> owners;
+};
+
+struct Pointers {
+  explicit Pointers(std::size_t n)
+  {
+    std::vector<Unique_ptr<Entity>> all;
+    for (std::size_t i = 0; i < 2 * n; ++i) {
+      all.push_back(make_unique<Entity>());
+    }
+    std::shuffle(all.begin(), all.end(), std::mt19937(42));
+    all.resize(n);
+    owners = std::move(all);
+  }
+
+  std::vector<Unique_ptr<Entity>> owners;
+};
+
+void BM_slot_map_iterate(benchmark::State &state)
+{
+  Slots s(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    for (Entity &e : s.map) {
+      e.x += e.vx;
+      e.y += e.vy;
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_unique_ptr_iterate(benchmark::State &state)
+{
+  Pointers p(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    for (auto &owner : p.owners) {
+      owner->x += owner->vx;
+      owner->y += owner->vy;
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Random access through the owners, e.g. following references between
+// entities
+void BM_slot_map_lookup(benchmark::State &state)
+{
+  Slots s(static_cast<std::size_t>(state.range(0)));
+  std::vector<Slot_handle<Entity>> handles;
+  for (auto &owner : s.owners) {
+    handles.push_back(owner.get());
+  }
+  std::shuffle(handles.begin(), handles.end(), std::mt19937(7));
+  for (auto _ : state) {
+    float sum = 0;
+    for (Slot_handle<Entity> h : handles) {
+      sum += h->x;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_unique_ptr_lookup(benchmark::State &state)
+{
+  Pointers p(static_cast<std::size_t>(state.range(0)));
+  std::vector<Entity *> handles;
+  for (auto &owner : p.owners) {
+    handles.push_back(owner.get());
+  }
+  std::shuffle(handles.begin(), handles.end(), std::mt19937(7));
+  for (auto _ : state) {
+    float sum = 0;
+    for (Entity *e : handles) {
+      sum += e->x;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+} // namespace
+
+BENCHMARK(BM_slot_map_iterate)->Arg(1 << 10)->Arg(1 << 18);
+BENCHMARK(BM_unique_ptr_iterate)->Arg(1 << 10)->Arg(1 << 18);
+BENCHMARK(BM_slot_map_lookup)->Arg(1 << 10)->Arg(1 << 18);
+BENCHMARK(BM_unique_ptr_lookup)->Arg(1 << 10)->Arg(1 << 18);
@@ -0,0 +1,77 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "spillable_ptr.h"
+
+// Access latency of Spillable_ptr values against how many of them may stay
+// resident. 256 values of 64 KiB are read with a Zipf-like skew, the cap is
+// a percentage of their total size. The spill file lives in the page cache,
+// so a fault costs a pread and a copy rather than a disk read.
+
+namespace
+{
+
+using Block = std::array<std::uint64_t, 8192>;
+
+constexpr std::size_t count = 256;
+
+// Indices with probability roughly proportional to 1 / (rank + 1)
+std::vector<std::size_t> skewed_indices(std::size_t n)
+{
+  std::vector<double> weights(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    weights[i] = 1.0 / static_cast<double>(i + 1);
+  }
+  std::mt19937_64 rng(42);
+  std::discrete_distribution<std::size_t> pick(weights.begin(), weights.end());
+  std::vector<std::size_t> indices(n);
+  for (auto &index : indices) {
+    index = pick(rng);
+  }
+  return indices;
+}
+
+void BM_access(benchmark::State &state)
+{
+  const auto percent = static_cast<std::size_t>(state.range(0));
+  Spill_policy policy;
+  policy.max_resident_bytes = count * sizeof(Block) * percent / 100;
+  const std::string path =
+      "spillable_bench_" + std::to_string(::getpid()) + ".spill";
+  Spill_store store(path.c_str(), policy);
+  if (!store) {
+    state.SkipWithError("can't create the spill file");
+    return;
+  }
+
+  std::vector<Spillable_ptr<Block>> values;
+  values.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    auto block = make_unique<Block>();
+    block->fill(i);
+    values.emplace_back(store, std::move(block));
+  }
+
+  const std::vector<std::size_t> indices = skewed_indices(1 << 16);
+  std::size_t next = 0;
+  for (auto _ : state) {
+    Block *block = values[indices[next]].get();
+    benchmark::DoNotOptimize((*block)[next % block->size()]);
+    next = (next + 1) % indices.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["resident_KiB"] =
+      static_cast<double>(store.resident_bytes()) / 1024;
+  state.counters["file_KiB"] = static_cast<double>(store.file_bytes()) / 1024;
+}
+
+} // namespace
+
+BENCHMARK(BM_access)->Arg(100)->Arg(50)->Arg(25)->Arg(10);
@@ -0,0 +1,63 @@
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <vector>
+
+#include "unique_buffer.h"
+
+namespace
+{
+
+constexpr std::size_t chunk_size = 64 * 1024;
+
+void BM_unique_buffer_append(benchmark::State &state)
+{
+  const auto total = static_cast<std::size_t>(state.range(0));
+  std::vector<char> chunk(chunk_size, 'x');
+  for (auto _ : state) {
+    Unique_buffer buf;
+    while (buf.size() < total) {
+      buf.append(chunk.data(), chunk.size());
+    }
+    benchmark::DoNotOptimize(buf.data());
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+// Grows by allocating a new buffer, copying and freeing the old one
+void BM_copy_grow_append(benchmark::State &state)
+{
+  const auto total = static_cast<std::size_t>(state.range(0));
+  std::vector<char> chunk(chunk_size, 'x');
+  for (auto _ : state) {
+    Unique_ptr<std::byte, Buffer_delete> buf;
+    std::size_t size = 0;
+    std::size_t capacity = 0;
+    while (size < total) {
+      if (size + chunk_size > capacity) {
+        capacity = capacity == 0 ? chunk_size : 2 * capacity;
+        Unique_ptr<std::byte, Buffer_delete> bigger(
+            static_cast<std::byte *>(std::malloc(capacity)));
+        if (size != 0) {
+          std::memcpy(bigger.get(), buf.get(), size);
+        }
+        buf = std::move(bigger);
+      }
+      std::memcpy(buf.get() + size, chunk.data(), chunk_size);
+      size += chunk_size;
+    }
+    benchmark::DoNotOptimize(buf.get());
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+} // namespace
+
+BENCHMARK(BM_unique_buffer_append)
+    ->RangeMultiplier(16)
+    ->Range(1 << 20, 1 << 30)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_copy_grow_append)
+    ->RangeMultiplier(16)
+    ->Range(1 << 20, 1 << 30)
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,143 @@
+#include <benchmark/benchmark.h>
+
+#include <coroutine>
+#include <utility>
+#include <vector>
+
+#include "unique_coroutine.h"
+
+// Spawning short coroutines that run once and finish: frames from operator
+// new owned by a raw coroutine_handle, by Unique_coroutine, and frames from
+// the per-thread Frame_pool. Spawned one at a time, and in batches that are
+// all alive at once before being destroyed.
+
+namespace
+{
+
+struct Heap_frame {
+};
+
+template <typename Base>
+struct Promise : Base {
+  std::coroutine_handle<Promise> get_return_object() noexcept
+  {
+    return std::coroutine_handle<Promise>::from_promise(*this);
+  }
+  std::suspend_always initial_suspend() noexcept
+  {
+    return {};
+  }
+  std::suspend_always final_suspend() noexcept
+  {
+    return {};
+  }
+  void return_value(int v) noexcept
+  {
+    result = v;
+  }
+  void unhandled_exception() noexcept {}
+
+  int result = 0;
+};
+
+// Destroys the frame by hand, as without an owner
+template <typename Base>
+class Raw_task
+{
+public:
+  using promise_type = Promise<Base>;
+
+  Raw_task(std::coroutine_handle<promise_type> handle) noexcept
+      : handle_(handle)
+  {
+  }
+
+  Raw_task(Raw_task &&other) noexcept
+      : handle_(std::exchange(other.handle_, nullptr))
+  {
+  }
+
+  ~Raw_task()
+  {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+  int run()
+  {
+    handle_.resume();
+    return handle_.promise().result;
+  }
+
+private:
+  std::coroutine_handle<promise_type> handle_;
+};
+
+template <typename Base>
+class Task
+{
+public:
+  using promise_type = Promise<Base>;
+
+  Task(std::coroutine_handle<promise_type> handle) noexcept : owner_(handle) {}
+
+  int run()
+  {
+    owner_.get().resume();
+    return owner_.get().promise().result;
+  }
+
+private:
+  Unique_coroutine<promise_type> owner_;
+};
+
+// A handler that does a little work
+template <typename T>
+T handler(int a, int b)
+{
+  int sum = 0;
+  for (int i = a; i < b; ++i) {
+    sum += i;
+  }
+  co_return sum;
+}
+
+template <typename T>
+void BM_spawn(benchmark::State &state)
+{
+  int a = 0;
+  for (auto _ : state) {
+    T task = handler<T>(a, a + 4);
+    benchmark::DoNotOptimize(task.run());
+    ++a;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+template <typename T>
+void BM_spawn_batch(benchmark::State &state)
+{
+  const auto n = static_cast<std::size_t>(state.range(0));
+  std::vector<T> tasks;
+  tasks.reserve(n);
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < n; ++i) {
+      tasks.push_back(handler<T>(0, 4));
+    }
+    for (T &task : tasks) {
+      benchmark::DoNotOptimize(task.run());
+    }
+    tasks.clear();
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_spawn, Raw_task<Heap_frame>);
+BENCHMARK_TEMPLATE(BM_spawn, Task<Heap_frame>);
+BENCHMARK_TEMPLATE(BM_spawn, Task<Pooled_frame>);
+BENCHMARK_TEMPLATE(BM_spawn_batch, Raw_task<Heap_frame>)->Arg(256);
+BENCHMARK_TEMPLATE(BM_spawn_batch, Task<Heap_frame>)->Arg(256);
+BENCHMARK_TEMPLATE(BM_spawn_batch, Task<Pooled_frame>)->Arg(256);
@@ -0,0 +1,95 @@
+#include <benchmark/benchmark.h>
+
+#include <deque>
+#include <functional>
+#include <memory>
+
+#include "unique_function.h"
+
+// Unique_function against std::function and, where the library has it,
+// std::move_only_function: calling a stored callable, and a task queue whose
+// tasks capture a Unique_ptr. std::function can't hold a move-only capture,
+// so its tasks capture a shared_ptr instead, as is done without a move-only
+// function.
+
+namespace
+{
+
+struct Payload {
+  long value = 1;
+};
+
+template <typename F>
+void BM_call(benchmark::State &state)
+{
+  long total = 0;
+  F f = [&total](long x) { total += x; };
+  benchmark::DoNotOptimize(f);
+  for (auto _ : state) {
+    f(1);
+  }
+  benchmark::DoNotOptimize(total);
+}
+
+struct Unique_task {
+  using F = Unique_function<void()>;
+
+  static F make(long &total)
+  {
+    return [&total, p = make_unique<Payload>()] { total += p->value; };
+  }
+};
+
+#ifdef __cpp_lib_move_only_function
+struct Move_only_task {
+  using F = std::move_only_function<void()>;
+
+  static F make(long &total)
+  {
+    return [&total, p = make_unique<Payload>()] { total += p->value; };
+  }
+};
+#endif
+
+struct Std_task {
+  using F = std::function<void()>;
+
+  static F make(long &total)
+  {
+    return [&total, p = std::make_shared<Payload>()] { total += p->value; };
+  }
+};
+
+// Tasks are pushed in batches of 64 and then run in order
+template <typename Task>
+void BM_queue(benchmark::State &state)
+{
+  long total = 0;
+  std::deque<typename Task::F> queue;
+  for (auto _ : state) {
+    for (int i = 0; i < 64; ++i) {
+      queue.push_back(Task::make(total));
+    }
+    while (!queue.empty()) {
+      typename Task::F task = std::move(queue.front());
+      queue.pop_front();
+      task();
+    }
+  }
+  benchmark::DoNotOptimize(total);
+  state.SetItemsProcessed(state.iterations() * 64);
+  state.counters["sizeof"] = sizeof(typename Task::F);
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_call, Unique_function<void(long)>);
+#ifdef __cpp_lib_move_only_function
+BENCHMARK_TEMPLATE(BM_call, std::move_only_function<void(long)>);
+#endif
+BENCHMARK_TEMPLATE(BM_call, std::function<void(long)>);
+BENCHMARK_TEMPLATE(BM_queue, Unique_task);
+#ifdef __cpp_lib_move_only_function
+BENCHMARK_TEMPLATE(BM_queue, Move_only_task);
+#endif
+BENCHMARK_TEMPLATE(BM_queue, Std_task);
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "unique_ptr.h"
+
+namespace detail
+{
+
+// Pointer type a deleter is called with: D::pointer if present, otherwise the
+// parameter of its (non-overloaded, non-template) function call operator.
+// There is no type member if neither exists.
+template <typename F>
+struct Call_arg {
+};
+
+template <typename R, typename A>
+struct Call_arg<R (*)(A)> {
+  using type = A;
+};
+
+template <typename R, typename A>
+struct Call_arg<R (*)(A) noexcept> {
+  using type = A;
+};
+
+template <typename C, typename R, typename A>
+struct Call_arg<R (C::*)(A)> {
+  using type = A;
+};
+
+template <typename C, typename R, typename A>
+struct Call_arg<R (C::*)(A) const> {
+  using type = A;
+};
+
+template <typename C, typename R, typename A>
+struct Call_arg<R (C::*)(A) noexcept> {
+  using type = A;
+};
+
+template <typename C, typename R, typename A>
+struct Call_arg<R (C::*)(A) const noexcept> {
+  using type = A;
+};
+
+template <typename D>
+concept Has_pointer_member = requires
+{
+  typename D::pointer;
+};
+
+template <typename D>
+concept Has_call_operator = requires
+{
+  &D::operator();
+};
+
+template <typename D>
+struct Deleter_arg {
+};
+
+template <typename D>
+requires(Has_call_operator<D> && !Has_pointer_member<D>) struct Deleter_arg<D>
+    : Call_arg<decltype(&D::operator())> {
+};
+
+template <typename R, typename A>
+struct Deleter_arg<R (*)(A)> {
+  using type = A;
+};
+
+template <typename R, typename A>
+struct Deleter_arg<R (*)(A) noexcept> {
+  using type = A;
+};
+
+// Preferred over the call operator, which can then be a template
+template <Has_pointer_member D>
+struct Deleter_arg<D> {
+  using type = typename D::pointer;
+};
+
+} // namespace detail
+
+// Type-erased deleter for heterogeneous owners such as
+// Unique_ptr<void, Any_delete>. Callables of up to inline_size bytes are
+// stored inline and never allocate, larger ones are boxed on the heap. Calling
+// the deleter is a single indirect call.
+class Any_delete
+{
+public:
+  static constexpr std::size_t inline_size = 2 * sizeof(void *);
+
+  // Effects: Constructs a deleter that does nothing.
+  Any_delete() noexcept = default;
+
+  // Constraints: D is not Any_delete, is nothrow move constructible, and its
+  // pointer type (D::pointer or the parameter of its call operator) is a
+  // pointer that void* can be converted back to. Deleters with a template
+  // call operator, e.g. a Delete_chain, need a pointer member.
+  // Effects: Stores d, inline if it fits, and calls it with the original
+  // pointer type.
+  template <typename D>
+  Any_delete(D d) requires(
+      !std::is_same_v<D, Any_delete> &&
+      std::is_nothrow_move_constructible_v<D> &&
+      std::is_pointer_v<typename detail::Deleter_arg<D>::type>)
+  {
+    using Arg = typename detail::Deleter_arg<D>::type;
+
+    if constexpr (fits_inline<D>) {
+      ::new (static_cast<void *>(storage_)) D(std::move(d));
+      invoke_ = [](void *storage, void *ptr) {
+        (*static_cast<D *>(storage))(static_cast<Arg>(ptr));
+      };
+      if constexpr (!std::is_trivially_copyable_v<D>) {
+        manage_ = [](void *dst, void *src) noexcept {
+          if (dst != nullptr) {
+            ::new (dst) D(std::move(*static_cast<D *>(src)));
+          }
+          static_cast<D *>(src)->~D();
+        };
+      }
+    } else {
+      ::new (static_cast<void *>(storage_)) D *(new D(std::move(d)));
+      invoke_ = [](void *storage, void *ptr) {
+        (**static_cast<D **>(storage))(static_cast<Arg>(ptr));
+      };
+      manage_ = [](void *dst, void *src) noexcept {
+        if (dst != nullptr) {
+          ::new (dst) D *(*static_cast<D **>(src));
+        } else {
+          delete *static_cast<D **>(src);
+        }
+      };
+    }
+  }
+
+  Any_delete(Any_delete &&other) noexcept
+      : invoke_(other.invoke_), manage_(other.manage_)
+  {
+    relocate(other);
+  }
+
+  Any_delete &operator=(Any_delete &&other) noexcept
+  {
+    if (this != &other) {
+      destroy();
+      invoke_ = other.invoke_;
+      manage_ = other.manage_;
+      relocate(other);
+    }
+    return *this;
+  }
+
+  ~Any_delete()
+  {
+    destroy();
+  }
+
+  void operator()(void *ptr)
+  {
+    invoke_(storage_, ptr);
+  }
+
+  Any_delete(const Any_delete &) = delete;
+  Any_delete &operator=(const Any_delete &) = delete;
+
+private:
+  template <typename D>
+  static constexpr bool fits_inline =
+      sizeof(D) <= inline_size && alignof(D) <= alignof(void *);
+
+  // Moves other's callable into this and leaves other doing nothing
+  void relocate(Any_delete &other) noexcept
+  {
+    if (manage_ != nullptr) {
+      manage_(storage_, other.storage_);
+    } else {
+      std::memcpy(storage_, other.storage_, inline_size);
+    }
+    other.invoke_ = &noop;
+    other.manage_ = nullptr;
+  }
+
+  void destroy() noexcept
+  {
+    if (manage_ != nullptr) {
+      manage_(nullptr, storage_);
+    }
+  }
+
+  static void noop(void *, void *) {}
+
+  alignas(void *) unsigned char storage_[inline_size];
+  void (*invoke_)(void *storage, void *ptr) = &noop;
+  // Moves (dst != nullptr) or destroys (dst == nullptr) the stored callable,
+  // nullptr if it is trivially copyable and stored inline
+  void (*manage_)(void *dst, void *src) noexcept = nullptr;
+};
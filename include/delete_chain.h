@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "unique_ptr.h"
+
+namespace detail
+{
+
+// Storage for the stage of a Delete_chain at position I, counted from the
+// end. Empty stages are stored as a base class so that a chain of empty
+// stages is empty itself, which a [[no_unique_address]] member would not
+// give. The position keeps repeated stage types apart.
+template <std::size_t I, typename D>
+class Chain_stage
+{
+public:
+  constexpr Chain_stage() noexcept = default;
+
+  constexpr explicit Chain_stage(D stage) noexcept : stage_(std::move(stage))
+  {
+  }
+
+  constexpr D &get() noexcept
+  {
+    return stage_;
+  }
+
+private:
+  D stage_{};
+};
+
+template <std::size_t I, typename D>
+requires(std::is_empty_v<D> && !std::is_final_v<D>) class Chain_stage<I, D>
+    : private D
+{
+public:
+  constexpr Chain_stage() noexcept = default;
+
+  constexpr explicit Chain_stage(D stage) noexcept : D(std::move(stage)) {}
+
+  constexpr D &get() noexcept
+  {
+    return *this;
+  }
+};
+
+} // namespace detail
+
+// Deleter that calls each of its stages with the pointer, in order, e.g.
+// Delete_chain<Record_stats, Destroy, Pool_return>. Empty stages take no
+// storage and a chain of empty stages is empty itself. Usable in constant
+// expressions when all stages are.
+template <typename... Ds>
+class Delete_chain;
+
+template <>
+class Delete_chain<>
+{
+public:
+  template <typename P>
+  constexpr void operator()(P) noexcept
+  {
+  }
+};
+
+template <typename D, typename... Ds>
+class Delete_chain<D, Ds...>
+    : private detail::Chain_stage<sizeof...(Ds), D>,
+      private Delete_chain<Ds...>
+{
+  using Stage = detail::Chain_stage<sizeof...(Ds), D>;
+  using Rest = Delete_chain<Ds...>;
+
+public:
+  constexpr Delete_chain() noexcept = default;
+
+  // Effects: Initializes the stages with the given deleters.
+  constexpr explicit Delete_chain(D d, Ds... ds) noexcept
+      : Stage(std::move(d)), Rest(std::move(ds)...)
+  {
+  }
+
+  // Effects: Calls every stage with ptr, first to last.
+  template <typename P>
+  constexpr void operator()(P ptr)
+  {
+    Stage::get()(ptr);
+    Rest::operator()(ptr);
+  }
+
+  // Returns: A reference to the stage at index I.
+  template <std::size_t I>
+  constexpr auto &get() noexcept
+  {
+    if constexpr (I == 0) {
+      return Stage::get();
+    } else {
+      return Rest::template get<I - 1>();
+    }
+  }
+};
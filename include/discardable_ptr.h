@@ -0,0 +1,246 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include "lru_list.h"
+#include "unique_ptr.h"
+
+namespace detail
+{
+
+// What the registry knows of a Discardable_ptr: its links, the bytes its
+// value pins and how to drop it
+struct Discardable_entry : Lru_hook {
+  void (*drop)(Discardable_entry *) noexcept;
+  std::size_t bytes;
+};
+
+} // namespace detail
+
+// The resident Discardable_ptrs in recency order. Not thread-safe: the
+// registry, its objects and the monitor polling it belong to one thread,
+// e.g. an event loop. References obtained from a Discardable_ptr stay valid
+// until the next discard.
+class Discardable_registry
+{
+public:
+  Discardable_registry() noexcept = default;
+
+  Discardable_registry(const Discardable_registry &) = delete;
+  Discardable_registry &operator=(const Discardable_registry &) = delete;
+
+  // Returns: The bytes pinned by resident values.
+  std::size_t resident_bytes() const noexcept
+  {
+    return resident_;
+  }
+
+  // Effects: Drops values, least recently used first, until at least bytes
+  // were freed or nothing is left.
+  // Returns: The bytes freed.
+  std::size_t discard(std::size_t bytes) noexcept
+  {
+    std::size_t freed = 0;
+    while (freed < bytes && !list_.empty()) {
+      auto *entry = static_cast<detail::Discardable_entry *>(list_.back());
+      remove(entry);
+      entry->drop(entry);
+      freed += entry->bytes;
+    }
+    return freed;
+  }
+
+private:
+  template <typename T, typename F>
+  friend class Discardable_ptr;
+
+  void add(detail::Discardable_entry *entry) noexcept
+  {
+    list_.push_front(entry);
+    resident_ += entry->bytes;
+  }
+
+  void remove(detail::Discardable_entry *entry) noexcept
+  {
+    list_.remove(entry);
+    resident_ -= entry->bytes;
+  }
+
+  Lru_list list_;
+  std::size_t resident_ = 0;
+};
+
+// Owns a value that can be regenerated: factory() returns a Unique_ptr<T>.
+// The value is created on first access and can be dropped by its registry,
+// coldest first, e.g. when a Memory_pressure_monitor sees the host running
+// low on memory. The next access rebuilds it.
+template <typename T, typename F>
+class Discardable_ptr : private detail::Discardable_entry
+{
+public:
+  // bytes is what the value pins, for the registry's accounting
+  Discardable_ptr(Discardable_registry &registry, F factory,
+                  std::size_t bytes = sizeof(T))
+      : Discardable_entry{{}, &drop_value, bytes},
+        factory_(std::move(factory)),
+        registry_(&registry)
+  {
+  }
+
+  Discardable_ptr(Discardable_ptr &&other) noexcept(
+      std::is_nothrow_move_constructible_v<F>)
+      : Discardable_entry{{}, &drop_value, other.bytes},
+        value_(std::move(other.value_)),
+        factory_(std::move(other.factory_)),
+        registry_(other.registry_)
+  {
+    if (registry_->list_.contains(&other)) {
+      registry_->list_.replace(&other, this);
+    }
+  }
+
+  Discardable_ptr &operator=(Discardable_ptr &&) = delete;
+
+  ~Discardable_ptr()
+  {
+    if (value_ != nullptr) {
+      registry_->remove(this);
+    }
+  }
+
+  // Effects: Regenerates the value if it was discarded and marks it as the
+  // most recently used.
+  // Returns: The value, or nullptr if the factory returned nullptr.
+  T *get()
+  {
+    if (value_ != nullptr) {
+      registry_->list_.touch(this);
+    } else {
+      value_ = std::invoke(factory_);
+      if (value_ != nullptr) {
+        registry_->add(this);
+      }
+    }
+    return value_.get();
+  }
+
+  T &operator*()
+  {
+    return *get();
+  }
+
+  T *operator->()
+  {
+    return get();
+  }
+
+  // Returns: true if the value is in memory.
+  bool resident() const noexcept
+  {
+    return value_ != nullptr;
+  }
+
+  // Effects: Drops the value now.
+  void discard() noexcept
+  {
+    if (value_ != nullptr) {
+      registry_->remove(this);
+      value_.reset();
+    }
+  }
+
+private:
+  static void drop_value(detail::Discardable_entry *entry) noexcept
+  {
+    static_cast<Discardable_ptr *>(entry)->value_.reset();
+  }
+
+  Unique_ptr<T> value_;
+  F factory_;
+  Discardable_registry *registry_;
+};
+
+template <typename F>
+Discardable_ptr(Discardable_registry &, F, std::size_t = 0)
+    -> Discardable_ptr<typename std::invoke_result_t<F &>::element_type, F>;
+
+// Where to read memory pressure from and when to act on it. The paths can
+// point elsewhere, e.g. to a cgroup's memory.pressure or to test files.
+struct Memory_pressure_config {
+  const char *psi_path = "/proc/pressure/memory";
+  const char *meminfo_path = "/proc/meminfo";
+  // Pressure if tasks were stalled on memory more than this percentage of the
+  // last 10 seconds ("some avg10")
+  double psi_some_avg10 = 10.0;
+  // Pressure if MemAvailable is below this fraction of MemTotal
+  double min_available = 0.1;
+  // Fraction of the resident bytes discarded per poll under pressure
+  double discard_fraction = 0.25;
+};
+
+// Polls PSI and /proc/meminfo and shrinks a Discardable_registry while
+// memory is tight. Files that can't be read count as no pressure.
+class Memory_pressure_monitor
+{
+public:
+  explicit Memory_pressure_monitor(Memory_pressure_config config = {}) noexcept
+      : config_(config)
+  {
+  }
+
+  bool under_pressure() const noexcept
+  {
+    return psi_pressure() || meminfo_pressure();
+  }
+
+  // Effects: If under pressure, discards discard_fraction of the registry's
+  // resident bytes, least recently used first.
+  // Returns: The bytes freed.
+  std::size_t poll(Discardable_registry &registry) const noexcept
+  {
+    if (!under_pressure()) {
+      return 0;
+    }
+    const auto bytes = static_cast<std::size_t>(
+        static_cast<double>(registry.resident_bytes()) *
+        config_.discard_fraction);
+    return registry.discard(bytes == 0 ? 1 : bytes);
+  }
+
+private:
+  bool psi_pressure() const noexcept
+  {
+    std::FILE *file = std::fopen(config_.psi_path, "r");
+    if (file == nullptr) {
+      return false;
+    }
+    double avg10 = 0;
+    const bool read = std::fscanf(file, "some avg10=%lf", &avg10) == 1;
+    std::fclose(file);
+    return read && avg10 > config_.psi_some_avg10;
+  }
+
+  bool meminfo_pressure() const noexcept
+  {
+    std::FILE *file = std::fopen(config_.meminfo_path, "r");
+    if (file == nullptr) {
+      return false;
+    }
+    unsigned long long total = 0;
+    unsigned long long available = 0;
+    char line[128];
+    while (std::fgets(line, sizeof(line), file) != nullptr) {
+      std::sscanf(line, "MemTotal: %llu kB", &total);
+      std::sscanf(line, "MemAvailable: %llu kB", &available);
+    }
+    std::fclose(file);
+    return total != 0 && static_cast<double>(available) <
+                             static_cast<double>(total) * config_.min_available;
+  }
+
+  Memory_pressure_config config_;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <type_traits>
+
+#include "unique_ptr.h"
+
+namespace detail
+{
+
+// Out-of-line core shared by every Erased_delete specialization. Kept out of
+// line on purpose so all rarely-used deleters funnel through one copy.
+[[gnu::noinline]] inline void erased_delete(void (*fn)(void *),
+                                            void *ptr) noexcept
+{
+  fn(ptr);
+}
+
+} // namespace detail
+
+// Deleter that type-erases a stateless deleter into a function pointer.
+// Unique_ptr<T, Erased_delete<T>> has the same code for its destructor, reset
+// and move operations regardless of the original deleter, at the cost of one
+// indirect call and one extra pointer of storage. Not usable in constant
+// expressions.
+template <typename T>
+class Erased_delete
+{
+public:
+  // Effects: Erases Default_delete<T>.
+  constexpr Erased_delete() noexcept : fn_(&invoke<Default_delete<T>>) {}
+
+  // Constraints: D is empty, default constructible and invocable with T*.
+  // Effects: Erases D. Every call default constructs a new D, so D must not
+  // depend on the identity of the object it was constructed from.
+  template <typename D>
+  constexpr Erased_delete(const D &) noexcept
+      requires(std::is_empty_v<D> && std::is_default_constructible_v<D> &&
+               std::is_invocable_v<D &, T *>)
+      : fn_(&invoke<D>)
+  {
+  }
+
+  void operator()(T *ptr) const
+  {
+    detail::erased_delete(fn_, const_cast<std::remove_cv_t<T> *>(ptr));
+  }
+
+private:
+  template <typename D>
+  static void invoke(void *ptr)
+  {
+    D()(static_cast<T *>(ptr));
+  }
+
+  void (*fn_)(void *);
+};
@@ -0,0 +1,12 @@
+#pragma once
+
+// Describes the owning children of Node for flat_save and freeze, e.g.
+//
+//   template <>
+//   struct Flat_layout<Node> {
+//     static constexpr std::array children{&Node::left, &Node::right};
+//   };
+//
+// Every child member is a Unique_ptr to Node.
+template <typename Node>
+struct Flat_layout;
@@ -0,0 +1,343 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "flat_layout.h"
+#include "unique_buffer.h"
+#include "unique_ptr.h"
+
+namespace detail
+{
+
+struct Flat_header {
+  std::uint32_t magic;
+  std::uint32_t version;
+  std::uint32_t node_size;
+  std::uint32_t stride;
+  std::uint64_t count;
+};
+
+// A flat buffer is a Flat_header followed by count fixed-size records in
+// depth-first preorder, the root first. A record is the node's bytes with its
+// children nulled, followed by one int64 per child: the byte distance to the
+// child's record, or 0 if there is no child.
+template <typename Node>
+struct Flat_format {
+  static constexpr std::uint32_t magic = 0x464c4154; // "FLAT"
+  static constexpr std::uint32_t version = 1;
+
+  static constexpr auto &children = Flat_layout<Node>::children;
+  static constexpr std::size_t align = alignof(Node) > alignof(std::int64_t)
+                                           ? alignof(Node)
+                                           : alignof(std::int64_t);
+  static constexpr std::size_t links =
+      (sizeof(Node) + alignof(std::int64_t) - 1) / alignof(std::int64_t) *
+      alignof(std::int64_t);
+  static constexpr std::size_t stride =
+      (links + children.size() * sizeof(std::int64_t) + align - 1) / align *
+      align;
+  static constexpr std::size_t records =
+      (sizeof(Flat_header) + align - 1) / align * align;
+
+  static_assert(align <= alignof(std::max_align_t),
+                "over-aligned nodes are not supported");
+
+  // Records are Node's bytes, copied out and back in with memcpy. That is
+  // only sound for a standard-layout Node whose children are plain pointers
+  // with an empty deleter, so the bytes of a null child are all that makes
+  // it null. The other members must be trivially copyable, which can't be
+  // checked.
+  using Owner = std::remove_cvref_t<
+      decltype(std::declval<Node &>().*children[0])>;
+  static_assert(std::is_standard_layout_v<Node>,
+                "flat nodes must be standard-layout");
+  static_assert(std::is_same_v<typename Owner::pointer, Node *> &&
+                    std::is_empty_v<typename Owner::deleter_type> &&
+                    std::is_trivially_copyable_v<
+                        typename Owner::deleter_type>,
+                "flat children must be Unique_ptrs to Node with an empty "
+                "deleter");
+
+  static std::int64_t link(const std::byte *record, std::size_t i) noexcept
+  {
+    std::int64_t offset;
+    std::memcpy(&offset, record + links + i * sizeof(offset), sizeof(offset));
+    return offset;
+  }
+
+  // Returns: The number of records, or 0 if data does not hold a valid
+  // header for Node and enough bytes for the records.
+  static std::size_t count(std::span<const std::byte> data) noexcept
+  {
+    Flat_header header;
+    if (data.size() < records) {
+      return 0;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != magic || header.version != version ||
+        header.node_size != sizeof(Node) || header.stride != stride ||
+        header.count > (data.size() - records) / stride) {
+      return 0;
+    }
+    return static_cast<std::size_t>(header.count);
+  }
+
+  template <typename Member>
+  static std::size_t index_of(Member member) noexcept
+  {
+    std::size_t i = 0;
+    while (children[i] != member) {
+      ++i;
+    }
+    return i;
+  }
+};
+
+} // namespace detail
+
+// Effects: Replaces the contents of out with a flat copy of the tree at
+// root, which may be nullptr, in a single depth-first pass. The buffer holds
+// no addresses and can be written to a file and loaded in another process.
+// Mandates: Node is standard-layout and its children are Unique_ptr<Node>
+// with an empty deleter.
+// Preconditions: Node's members other than its children are trivially
+// copyable. Records are Node's bytes, read in place by Flat_view.
+// Returns: false if growing out failed.
+template <typename Node>
+bool flat_save(const Node *root, Unique_buffer &out)
+{
+  using Format = detail::Flat_format<Node>;
+
+  struct Pending {
+    const Node *node;
+    std::size_t parent;
+    std::size_t child;
+  };
+  std::vector<Pending> stack;
+  if (root != nullptr) {
+    stack.push_back({root, 0, 0});
+  }
+
+  out.clear();
+  if (!out.resize(Format::records)) {
+    return false;
+  }
+  std::size_t count = 0;
+  while (!stack.empty()) {
+    const Pending pending = stack.back();
+    stack.pop_back();
+
+    const std::size_t at = out.size();
+    if (!out.resize(at + Format::stride)) {
+      return false;
+    }
+    ++count;
+    std::byte *record = out.data() + at;
+    if (pending.parent != 0) {
+      const auto offset = static_cast<std::int64_t>(at - pending.parent);
+      std::memcpy(out.data() + pending.parent + Format::links +
+                      pending.child * sizeof(offset),
+                  &offset, sizeof(offset));
+    }
+
+    const auto *node = reinterpret_cast<const std::byte *>(pending.node);
+    std::memcpy(record, node, sizeof(Node));
+    std::memset(record + Format::links, 0,
+                Format::children.size() * sizeof(std::int64_t));
+    // Pushed in reverse, so the first child gets the next record
+    for (std::size_t c = Format::children.size(); c-- > 0;) {
+      const auto &owner = pending.node->*Format::children[c];
+      const std::remove_cvref_t<decltype(owner)> null;
+      std::memcpy(record + (reinterpret_cast<const std::byte *>(&owner) - node),
+                  &null, sizeof(null));
+      if (owner != nullptr) {
+        stack.push_back({owner.get(), at, c});
+      }
+    }
+  }
+
+  const detail::Flat_header header{Format::magic, Format::version,
+                                   sizeof(Node), Format::stride, count};
+  std::memcpy(out.data(), &header, sizeof(header));
+  return true;
+}
+
+// Read-only view of a node in a flat buffer. The node is used in place, its
+// child members are null: children are reached through child().
+template <typename Node>
+class Flat_view
+{
+public:
+  constexpr Flat_view() noexcept = default;
+
+  explicit Flat_view(const std::byte *record) noexcept : record_(record)
+  {
+  }
+
+  const Node &operator*() const noexcept
+  {
+    return *get();
+  }
+
+  const Node *operator->() const noexcept
+  {
+    return get();
+  }
+
+  const Node *get() const noexcept
+  {
+    return std::launder(reinterpret_cast<const Node *>(record_));
+  }
+
+  explicit operator bool() const noexcept
+  {
+    return record_ != nullptr;
+  }
+
+  // Preconditions: *this is not empty and
+  // i < Flat_layout<Node>::children.size().
+  // Returns: A view of the i-th child, empty if there is none.
+  Flat_view child(std::size_t i) const noexcept
+  {
+    const std::int64_t offset = detail::Flat_format<Node>::link(record_, i);
+    return offset == 0 ? Flat_view() : Flat_view(record_ + offset);
+  }
+
+  // Returns: A view of the child owned by member.
+  template <typename Owner>
+  Flat_view child(Owner Node::*member) const noexcept
+  {
+    return child(detail::Flat_format<Node>::index_of(member));
+  }
+
+private:
+  const std::byte *record_ = nullptr;
+};
+
+// Preconditions: data was written by flat_save, possibly in another process,
+// and is aligned to alignof(std::max_align_t). Only the header is checked.
+// Returns: A view of the root, empty if data holds no tree of Node.
+template <typename Node>
+Flat_view<Node> flat_view(std::span<const std::byte> data) noexcept
+{
+  using Format = detail::Flat_format<Node>;
+  if (Format::count(data) == 0) {
+    return Flat_view<Node>();
+  }
+  return Flat_view<Node>(data.data() + Format::records);
+}
+
+// Deleter for trees rebuilt by flat_load: all nodes are in one array, so the
+// children are released instead of deleted, then the array is destroyed and
+// freed at once.
+template <typename Node>
+class Flat_arena_delete
+{
+public:
+  constexpr Flat_arena_delete() noexcept = default;
+
+  constexpr explicit Flat_arena_delete(std::size_t count) noexcept
+      : count_(count)
+  {
+  }
+
+  // Returns: The number of nodes in the arena.
+  constexpr std::size_t count() const noexcept
+  {
+    return count_;
+  }
+
+  void operator()(Node *nodes) const noexcept
+  {
+    for (std::size_t i = 0; i < count_; ++i) {
+      for (auto child : detail::Flat_format<Node>::children) {
+        static_cast<void>((nodes[i].*child).release());
+      }
+      std::destroy_at(nodes + i);
+    }
+    ::operator delete(nodes, count_ * sizeof(Node),
+                      std::align_val_t{alignof(Node)});
+  }
+
+private:
+  std::size_t count_ = 0;
+};
+
+// A tree rebuilt by flat_load. Nodes must stay in the tree: a child moved out
+// of it would be deleted on its own.
+template <typename Node>
+using Unique_flat_ptr = Unique_ptr<Node, Flat_arena_delete<Node>>;
+
+// Preconditions: data was written by flat_save and is aligned to
+// alignof(std::max_align_t).
+// Returns: A copy of the tree in data with all nodes in a single allocation,
+// or an empty owner if data holds no valid tree of Node or the allocation
+// failed.
+template <typename Node>
+Unique_flat_ptr<Node> flat_load(std::span<const std::byte> data) noexcept
+{
+  using Format = detail::Flat_format<Node>;
+  const std::size_t count = Format::count(data);
+  if (count == 0) {
+    return Unique_flat_ptr<Node>();
+  }
+
+  // Links point forward and every record but the root has exactly one
+  // parent, so the records form a tree and each node gets a single owner
+  Unique_buffer linked;
+  if (!linked.resize(count)) {
+    return Unique_flat_ptr<Node>();
+  }
+  std::memset(linked.data(), 0, count);
+  std::size_t links = 0;
+  const std::byte *records = data.data() + Format::records;
+  for (std::size_t i = 0; i < count; ++i) {
+    for (std::size_t c = 0; c < Format::children.size(); ++c) {
+      const std::int64_t offset =
+          Format::link(records + i * Format::stride, c);
+      if (offset == 0) {
+        continue;
+      }
+      if (offset < 0 || offset % Format::stride != 0 ||
+          static_cast<std::size_t>(offset) / Format::stride >= count - i) {
+        return Unique_flat_ptr<Node>();
+      }
+      const std::size_t child =
+          i + static_cast<std::size_t>(offset) / Format::stride;
+      if (linked.data()[child] != std::byte{0}) {
+        return Unique_flat_ptr<Node>();
+      }
+      linked.data()[child] = std::byte{1};
+      ++links;
+    }
+  }
+  if (links != count - 1) {
+    return Unique_flat_ptr<Node>();
+  }
+
+  auto *nodes = static_cast<Node *>(::operator new(
+      count * sizeof(Node), std::align_val_t{alignof(Node)}, std::nothrow));
+  if (nodes == nullptr) {
+    return Unique_flat_ptr<Node>();
+  }
+  for (std::size_t i = 0; i < count; ++i) {
+    const std::byte *record = records + i * Format::stride;
+    std::memcpy(static_cast<void *>(nodes + i), record, sizeof(Node));
+    for (std::size_t c = 0; c < Format::children.size(); ++c) {
+      const std::int64_t offset = Format::link(record, c);
+      if (offset != 0) {
+        const auto index = static_cast<std::size_t>(offset) / Format::stride;
+        (nodes[i].*Format::children[c]).reset(nodes + i + index);
+      }
+    }
+  }
+  return Unique_flat_ptr<Node>(nodes, Flat_arena_delete<Node>(count));
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "flat_layout.h"
+#include "unique_ptr.h"
+
+template <typename Node>
+class Frozen_view;
+
+namespace detail
+{
+
+template <typename Node>
+inline constexpr std::size_t frozen_children =
+    Flat_layout<Node>::children.size();
+
+template <typename Node>
+using Frozen_links = std::array<std::uint32_t, frozen_children<Node>>;
+
+template <typename Node>
+constexpr std::size_t frozen_count(const Node *node)
+{
+  if (node == nullptr) {
+    return 0;
+  }
+  std::size_t count = 1;
+  for (auto child : Flat_layout<Node>::children) {
+    count += frozen_count((node->*child).get());
+  }
+  return count;
+}
+
+} // namespace detail
+
+// A tree of Node in static storage: the nodes in breadth-first order, the
+// root first, and per node the indices of its children (0 for none, the root
+// is never a child). Made by freeze.
+template <typename Node, std::size_t N>
+class Frozen
+{
+public:
+  // Returns: A view of the root, empty if the tree is empty.
+  constexpr Frozen_view<Node> root() const noexcept
+  {
+    if constexpr (N == 0) {
+      return Frozen_view<Node>();
+    } else {
+      return Frozen_view<Node>(nodes_.data(), links_.data(), 0);
+    }
+  }
+
+  static constexpr std::size_t size() noexcept
+  {
+    return N;
+  }
+
+private:
+  template <typename Build>
+  friend constexpr auto freeze(Build);
+
+  std::array<Node, N> nodes_{};
+  std::array<detail::Frozen_links<Node>, N> links_{};
+};
+
+// Read-only view of a node of a Frozen tree, with the traversal API of
+// Flat_view. The node's child members are null: children are reached
+// through child().
+template <typename Node>
+class Frozen_view
+{
+public:
+  constexpr Frozen_view() noexcept = default;
+
+  constexpr Frozen_view(const Node *nodes,
+                        const detail::Frozen_links<Node> *links,
+                        std::uint32_t index) noexcept
+      : nodes_(nodes), links_(links), index_(index)
+  {
+  }
+
+  constexpr const Node &operator*() const noexcept
+  {
+    return nodes_[index_];
+  }
+
+  constexpr const Node *operator->() const noexcept
+  {
+    return get();
+  }
+
+  constexpr const Node *get() const noexcept
+  {
+    return nodes_ + index_;
+  }
+
+  constexpr explicit operator bool() const noexcept
+  {
+    return nodes_ != nullptr;
+  }
+
+  // Preconditions: *this is not empty and
+  // i < Flat_layout<Node>::children.size().
+  // Returns: A view of the i-th child, empty if there is none.
+  constexpr Frozen_view child(std::size_t i) const noexcept
+  {
+    const std::uint32_t index = links_[index_][i];
+    return index == 0 ? Frozen_view() : Frozen_view(nodes_, links_, index);
+  }
+
+  // Returns: A view of the child owned by member.
+  template <typename Owner>
+  constexpr Frozen_view child(Owner Node::*member) const noexcept
+  {
+    std::size_t i = 0;
+    while (Flat_layout<Node>::children[i] != member) {
+      ++i;
+    }
+    return child(i);
+  }
+
+private:
+  const Node *nodes_ = nullptr;
+  const detail::Frozen_links<Node> *links_ = nullptr;
+  std::uint32_t index_ = 0;
+};
+
+// Build is a captureless callable whose call builds a tree during constant
+// evaluation and returns its root, a Unique_ptr<Node>. Node must be default
+// constructible and move assignable.
+// Returns: The tree moved into a Frozen, so it can initialize a constexpr
+// variable and no construction is left for run time:
+//
+//   static constexpr auto table = freeze([] { return build_table(); });
+template <typename Build>
+constexpr auto freeze(Build)
+{
+  using Owner = decltype(Build{}());
+  using Node = typename Owner::element_type;
+  constexpr std::size_t count = detail::frozen_count(Build{}().get());
+
+  Frozen<Node, count> frozen;
+  std::vector<Owner> queue;
+  queue.reserve(count);
+  if (Owner root = Build{}()) {
+    queue.push_back(std::move(root));
+  }
+  for (std::size_t i = 0; i < queue.size(); ++i) {
+    Node &node = *queue[i];
+    // Children are detached first, so the frozen copy owns nothing
+    for (std::size_t c = 0; c < detail::frozen_children<Node>; ++c) {
+      Owner &child = node.*Flat_layout<Node>::children[c];
+      if (child != nullptr) {
+        frozen.links_[i][c] = static_cast<std::uint32_t>(queue.size());
+        queue.push_back(std::move(child));
+      }
+    }
+    frozen.nodes_[i] = std::move(node);
+  }
+  return frozen;
+}
@@ -0,0 +1,286 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "unique_ptr.h"
+
+class Io_buffer_pool;
+
+namespace detail
+{
+
+// Lock for the pool's free lists. Unlike std::mutex, locking can't throw, so
+// acquiring and returning buffers stays noexcept.
+class Spin_lock
+{
+public:
+  void lock() noexcept
+  {
+    while (flag_.test_and_set(std::memory_order_acquire)) {
+      flag_.wait(true, std::memory_order_relaxed);
+    }
+  }
+
+  void unlock() noexcept
+  {
+    flag_.clear(std::memory_order_release);
+    flag_.notify_one();
+  }
+
+private:
+  std::atomic_flag flag_;
+};
+
+} // namespace detail
+
+// Deleter for buffers from an Io_buffer_pool: hands the buffer back to its
+// pool, or frees it if it did not come from a size class.
+class Pool_return_delete
+{
+public:
+  constexpr Pool_return_delete() noexcept = default;
+
+  constexpr Pool_return_delete(Io_buffer_pool *pool, std::size_t size) noexcept
+      : pool_(pool), size_(size)
+  {
+  }
+
+  // Returns: The usable size of the buffer.
+  constexpr std::size_t size() const noexcept
+  {
+    return size_;
+  }
+
+  void operator()(std::byte *ptr) const noexcept;
+
+private:
+  Io_buffer_pool *pool_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+// Aligned I/O buffer, e.g. for O_DIRECT reads
+using Io_buffer = Unique_ptr<std::byte, Pool_return_delete>;
+
+// Pool of 4 KiB aligned buffers in power-of-4 size classes from 4 KiB to
+// 4 MiB. Released buffers are cached up to a per-class limit and handed out
+// again instead of going through aligned_alloc and free.
+//
+// shared() is a process-wide pool with a small per-thread cache in front of
+// it, so most acquires and releases don't take its lock. It is never
+// destroyed, and its buffers may outlive the thread that acquired them.
+// Buffers of any other pool must be released before that pool is destroyed.
+class Io_buffer_pool
+{
+public:
+  static constexpr std::size_t alignment = 4096;
+  static constexpr std::size_t min_size = 4096;
+  static constexpr std::size_t class_count = 6;
+  static constexpr std::size_t max_size = min_size << 2 * (class_count - 1);
+
+  explicit Io_buffer_pool(std::size_t max_cached = 64)
+      : Io_buffer_pool(max_cached, false)
+  {
+  }
+
+  ~Io_buffer_pool()
+  {
+    for (auto &list : free_) {
+      for (std::byte *ptr : list) {
+        std::free(ptr);
+      }
+    }
+  }
+
+  Io_buffer_pool(const Io_buffer_pool &) = delete;
+  Io_buffer_pool &operator=(const Io_buffer_pool &) = delete;
+
+  // Returns: The process-wide pool.
+  static Io_buffer_pool &shared()
+  {
+    // Leaked on purpose: buffers may be released during static destruction
+    static Io_buffer_pool *const pool = new Io_buffer_pool(64, true);
+    return *pool;
+  }
+
+  // Returns: A buffer of at least size bytes, rounded up to its size class,
+  // or an empty owner if the allocation failed. Sizes above max_size are
+  // allocated and freed directly.
+  Io_buffer acquire(std::size_t size) noexcept
+  {
+    if (size > max_size) {
+      const std::size_t rounded =
+          (size + alignment - 1) / alignment * alignment;
+      return Io_buffer(allocate(rounded), Pool_return_delete(nullptr, rounded));
+    }
+
+    const std::size_t cls = size_class(size);
+    if (thread_cached_) {
+      Thread_cache *cache = Thread_cache::get();
+      if (cache != nullptr && cache->count[cls] != 0) {
+        std::byte *ptr = cache->buffers[cls][--cache->count[cls]];
+        return Io_buffer(ptr, Pool_return_delete(this, class_size(cls)));
+      }
+    }
+    {
+      std::lock_guard lock(lock_);
+      if (!free_[cls].empty()) {
+        std::byte *ptr = free_[cls].back();
+        free_[cls].pop_back();
+        return Io_buffer(ptr, Pool_return_delete(this, class_size(cls)));
+      }
+    }
+    return Io_buffer(allocate(class_size(cls)),
+                     Pool_return_delete(this, class_size(cls)));
+  }
+
+  // Effects: Allocates up to count buffers of size's class, touches every
+  // page so later I/O does not fault, and caches them.
+  // Returns: The number of buffers added, 0 if size is above max_size.
+  std::size_t prefault(std::size_t size, std::size_t count) noexcept
+  {
+    if (size > max_size) {
+      return 0;
+    }
+    const std::size_t cls = size_class(size);
+    std::size_t added = 0;
+    for (; added < count; ++added) {
+      std::byte *ptr = allocate(class_size(cls));
+      if (ptr == nullptr) {
+        break;
+      }
+      std::memset(ptr, 0, class_size(cls));
+
+      std::lock_guard lock(lock_);
+      if (free_[cls].size() == max_cached_) {
+        std::free(ptr);
+        break;
+      }
+      free_[cls].push_back(ptr);
+    }
+    return added;
+  }
+
+  // Returns: The number of buffers in size's class cached by the pool itself,
+  // not counting per-thread caches.
+  std::size_t cached(std::size_t size) noexcept
+  {
+    if (size > max_size) {
+      return 0;
+    }
+    std::lock_guard lock(lock_);
+    return free_[size_class(size)].size();
+  }
+
+  // Returns: The size of the class a request for size bytes is served from.
+  static constexpr std::size_t class_size(std::size_t cls) noexcept
+  {
+    return min_size << 2 * cls;
+  }
+
+  // Preconditions: size <= max_size.
+  static constexpr std::size_t size_class(std::size_t size) noexcept
+  {
+    std::size_t cls = 0;
+    while (cls + 1 < class_count && class_size(cls) < size) {
+      ++cls;
+    }
+    return cls;
+  }
+
+private:
+  friend class Pool_return_delete;
+
+  // Buffers of shared() kept by one thread. They go back to the pool when
+  // the thread exits, buffers released after that go to the pool directly.
+  struct Thread_cache {
+    static constexpr std::size_t depth = 4;
+
+    ~Thread_cache()
+    {
+      destroyed() = true;
+      for (std::size_t cls = 0; cls < class_count; ++cls) {
+        while (count[cls] != 0) {
+          shared().give_back_locked(buffers[cls][--count[cls]], cls);
+        }
+      }
+    }
+
+    // Trivially destructible, so still usable during thread exit
+    static bool &destroyed() noexcept
+    {
+      thread_local bool flag = false;
+      return flag;
+    }
+
+    static Thread_cache *get() noexcept
+    {
+      if (destroyed()) {
+        return nullptr;
+      }
+      thread_local Thread_cache cache;
+      return &cache;
+    }
+
+    std::array<std::array<std::byte *, depth>, class_count> buffers{};
+    std::array<std::size_t, class_count> count{};
+  };
+
+  Io_buffer_pool(std::size_t max_cached, bool thread_cached)
+      : max_cached_(max_cached), thread_cached_(thread_cached)
+  {
+    // Returning buffers never allocates
+    for (auto &list : free_) {
+      list.reserve(max_cached_);
+    }
+  }
+
+  static std::byte *allocate(std::size_t size) noexcept
+  {
+    return static_cast<std::byte *>(std::aligned_alloc(alignment, size));
+  }
+
+  void give_back(std::byte *ptr, std::size_t size) noexcept
+  {
+    const std::size_t cls = size_class(size);
+    if (thread_cached_) {
+      Thread_cache *cache = Thread_cache::get();
+      if (cache != nullptr && cache->count[cls] < Thread_cache::depth) {
+        cache->buffers[cls][cache->count[cls]++] = ptr;
+        return;
+      }
+    }
+    give_back_locked(ptr, cls);
+  }
+
+  void give_back_locked(std::byte *ptr, std::size_t cls) noexcept
+  {
+    {
+      std::lock_guard lock(lock_);
+      if (free_[cls].size() < max_cached_) {
+        free_[cls].push_back(ptr);
+        return;
+      }
+    }
+    std::free(ptr);
+  }
+
+  detail::Spin_lock lock_;
+  std::array<std::vector<std::byte *>, class_count> free_;
+  std::size_t max_cached_;
+  bool thread_cached_;
+};
+
+inline void Pool_return_delete::operator()(std::byte *ptr) const noexcept
+{
+  if (pool_ != nullptr) {
+    pool_->give_back(ptr, size_);
+  } else {
+    std::free(ptr);
+  }
+}
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "unique_ptr.h"
+
+// Fixed-capacity cache of owned values, least recently used first out.
+// Entries live in one vector and are chained into the recency list by index,
+// the key index is an open-addressing table of entry indices with linear
+// probing. Neither allocates after construction.
+//
+// Whatever leaves the cache, by eviction, replacement or erase, is returned
+// as an Evicted holding the key and the owner. Dropping it runs the deleter
+// right away; keeping it defers that, e.g. until a lock is released, or hands
+// the value on to a write-back.
+//
+// K must be default constructible.
+template <typename K, typename V, typename D = Default_delete<V>,
+          typename Hash = std::hash<K>, typename Eq = std::equal_to<K>>
+class Lru_cache
+{
+public:
+  using owner = Unique_ptr<V, D>;
+
+  struct Evicted {
+    K key;
+    owner value;
+
+    explicit operator bool() const noexcept
+    {
+      return value != nullptr;
+    }
+  };
+
+  // Preconditions: capacity > 0.
+  explicit Lru_cache(std::size_t capacity)
+      : entries_(capacity),
+        index_(std::bit_ceil(2 * capacity), none),
+        mask_(index_.size() - 1)
+  {
+    for (std::size_t i = 0; i < capacity; ++i) {
+      entries_[i].next = static_cast<std::uint32_t>(i + 1);
+    }
+    entries_.back().next = none;
+  }
+
+  Lru_cache(const Lru_cache &) = delete;
+  Lru_cache &operator=(const Lru_cache &) = delete;
+
+  // Effects: Marks key as the most recently used, if it is cached.
+  // Returns: The cached value, or nullptr.
+  V *find(const K &key)
+  {
+    const auto [slot, found] = lookup(key);
+    if (!found) {
+      return nullptr;
+    }
+    const std::uint32_t i = index_[slot];
+    unlink(i);
+    push_front(i);
+    return entries_[i].value.get();
+  }
+
+  // Returns: The cached value, or nullptr. Recency is not updated.
+  V *peek(const K &key) const
+  {
+    const auto [slot, found] = lookup(key);
+    return found ? entries_[index_[slot]].value.get() : nullptr;
+  }
+
+  // Effects: Caches value under key as the most recently used entry. If key
+  // is cached already its value is replaced, otherwise if the cache is full
+  // the least recently used entry is evicted.
+  // Returns: The replaced or evicted entry, if any.
+  Evicted insert(K key, owner value)
+  {
+    auto [slot, found] = lookup(key);
+    if (found) {
+      Entry &entry = entries_[index_[slot]];
+      unlink(index_[slot]);
+      push_front(index_[slot]);
+      entry.value.swap(value);
+      return Evicted{std::move(key), std::move(value)};
+    }
+
+    Evicted evicted{};
+    if (size_ == entries_.size()) {
+      evicted = remove(lookup(entries_[tail_].key).first);
+      // Removing shifts entries back, the free slot may have moved
+      slot = lookup(key).first;
+    }
+
+    const std::uint32_t i = free_;
+    Entry &entry = entries_[i];
+    free_ = entry.next;
+    entry.key = std::move(key);
+    entry.value = std::move(value);
+    push_front(i);
+    index_[slot] = i;
+    ++size_;
+    return evicted;
+  }
+
+  // Returns: The entry for key, or an empty Evicted if key is not cached.
+  Evicted erase(const K &key)
+  {
+    const auto [slot, found] = lookup(key);
+    return found ? remove(slot) : Evicted{};
+  }
+
+  std::size_t size() const noexcept
+  {
+    return size_;
+  }
+
+  std::size_t capacity() const noexcept
+  {
+    return entries_.size();
+  }
+
+  bool empty() const noexcept
+  {
+    return size_ == 0;
+  }
+
+private:
+  static constexpr std::uint32_t none = ~std::uint32_t{0};
+
+  struct Entry {
+    K key{};
+    owner value;
+    std::uint32_t prev = none;
+    std::uint32_t next = none;
+  };
+
+  std::size_t home(const K &key) const
+  {
+    // Fibonacci hashing, std::hash is the identity for integers
+    return (Hash{}(key) * std::size_t{0x9e3779b97f4a7c15}) >>
+           (std::numeric_limits<std::size_t>::digits -
+            std::countr_zero(index_.size()));
+  }
+
+  // Returns: The slot holding key and true, or the empty slot where key
+  // would go and false.
+  std::pair<std::size_t, bool> lookup(const K &key) const
+  {
+    for (std::size_t slot = home(key);; slot = (slot + 1) & mask_) {
+      if (index_[slot] == none) {
+        return {slot, false};
+      }
+      if (Eq{}(entries_[index_[slot]].key, key)) {
+        return {slot, true};
+      }
+    }
+  }
+
+  Evicted remove(std::size_t slot)
+  {
+    const std::uint32_t i = index_[slot];
+    Entry &entry = entries_[i];
+    Evicted evicted{std::move(entry.key), std::move(entry.value)};
+    entry.key = K{};
+    unlink(i);
+    entry.next = free_;
+    free_ = i;
+    --size_;
+
+    // Backward shift: move later entries of the probe sequence into the
+    // hole unless that would put them before their home slot
+    index_[slot] = none;
+    for (std::size_t next = (slot + 1) & mask_; index_[next] != none;
+         next = (next + 1) & mask_) {
+      const std::size_t ideal = home(entries_[index_[next]].key);
+      if (((next - ideal) & mask_) >= ((next - slot) & mask_)) {
+        index_[slot] = index_[next];
+        index_[next] = none;
+        slot = next;
+      }
+    }
+    return evicted;
+  }
+
+  void unlink(std::uint32_t i) noexcept
+  {
+    Entry &entry = entries_[i];
+    (entry.prev == none ? head_ : entries_[entry.prev].next) = entry.next;
+    (entry.next == none ? tail_ : entries_[entry.next].prev) = entry.prev;
+  }
+
+  void push_front(std::uint32_t i) noexcept
+  {
+    Entry &entry = entries_[i];
+    entry.prev = none;
+    entry.next = head_;
+    (head_ == none ? tail_ : entries_[head_].prev) = i;
+    head_ = i;
+  }
+
+  std::vector<Entry> entries_;
+  std::vector<std::uint32_t> index_;
+  std::size_t mask_;
+  std::size_t size_ = 0;
+  std::uint32_t head_ = none;
+  std::uint32_t tail_ = none;
+  std::uint32_t free_ = 0;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+// Links of an object in an Lru_list, usually a base class of the object
+struct Lru_hook {
+  Lru_hook *prev = nullptr;
+  Lru_hook *next = nullptr;
+};
+
+// Intrusive doubly linked list in recency order, most recently used first.
+// Nothing is allocated or owned, objects unlink themselves before they die.
+class Lru_list
+{
+public:
+  bool empty() const noexcept
+  {
+    return head_ == nullptr;
+  }
+
+  bool contains(const Lru_hook *hook) const noexcept
+  {
+    return hook->prev != nullptr || head_ == hook;
+  }
+
+  // Returns: The most recently used object, or nullptr.
+  Lru_hook *front() const noexcept
+  {
+    return head_;
+  }
+
+  // Returns: The least recently used object, or nullptr.
+  Lru_hook *back() const noexcept
+  {
+    return tail_;
+  }
+
+  // Preconditions: hook is not in a list.
+  void push_front(Lru_hook *hook) noexcept
+  {
+    hook->prev = nullptr;
+    hook->next = head_;
+    (head_ == nullptr ? tail_ : head_->prev) = hook;
+    head_ = hook;
+  }
+
+  // Preconditions: hook is in this list.
+  void remove(Lru_hook *hook) noexcept
+  {
+    (hook->prev == nullptr ? head_ : hook->prev->next) = hook->next;
+    (hook->next == nullptr ? tail_ : hook->next->prev) = hook->prev;
+    hook->prev = nullptr;
+    hook->next = nullptr;
+  }
+
+  // Effects: Makes hook the most recently used.
+  // Preconditions: hook is in this list.
+  void touch(Lru_hook *hook) noexcept
+  {
+    if (hook != head_) {
+      remove(hook);
+      push_front(hook);
+    }
+  }
+
+  // Effects: Puts to in from's place, e.g. when the object moves.
+  // Preconditions: from is in this list, to is not in a list.
+  void replace(Lru_hook *from, Lru_hook *to) noexcept
+  {
+    to->prev = from->prev;
+    to->next = from->next;
+    (to->prev == nullptr ? head_ : to->prev->next) = to;
+    (to->next == nullptr ? tail_ : to->next->prev) = to;
+    from->prev = nullptr;
+    from->next = nullptr;
+  }
+
+private:
+  Lru_hook *head_ = nullptr;
+  Lru_hook *tail_ = nullptr;
+};
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "unique_ptr.h"
+
+namespace detail
+{
+
+// Start of a block created by make_unique_group. Counts the members of the
+// group that are still alive, the block is freed when the last one dies.
+struct Group_header {
+  std::atomic<std::size_t> alive;
+  std::size_t bytes;
+  std::align_val_t align;
+
+  // Drops one member, frees the block if it was the last
+  void release() noexcept
+  {
+    if (alive.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      std::size_t b = bytes;
+      std::align_val_t a = align;
+      this->~Group_header();
+      ::operator delete(static_cast<void *>(this), b, a);
+    }
+  }
+};
+
+// Drops one reference of a group without destroying any member
+struct Group_release {
+  void operator()(Group_header *header) const noexcept
+  {
+    header->release();
+  }
+};
+
+constexpr std::size_t align_up(std::size_t n, std::size_t align) noexcept
+{
+  return (n + align - 1) / align * align;
+}
+
+// Offsets of the header, the parent and each child within a group block
+template <typename Parent, typename... Children>
+struct Group_layout {
+  static constexpr std::size_t count = 1 + sizeof...(Children);
+  static constexpr std::size_t sizes[count] = {sizeof(Parent),
+                                               sizeof(Children)...};
+  static constexpr std::size_t aligns[count] = {alignof(Parent),
+                                                alignof(Children)...};
+
+  static constexpr std::array<std::size_t, count> offsets = [] {
+    std::array<std::size_t, count> result{};
+    std::size_t end = sizeof(Group_header);
+    for (std::size_t i = 0; i < count; ++i) {
+      result[i] = align_up(end, aligns[i]);
+      end = result[i] + sizes[i];
+    }
+    return result;
+  }();
+
+  static constexpr std::size_t bytes =
+      offsets[count - 1] + sizes[count - 1];
+
+  static constexpr std::align_val_t align = [] {
+    std::size_t result = alignof(Group_header);
+    for (std::size_t a : aligns) {
+      result = a > result ? a : result;
+    }
+    return std::align_val_t{result};
+  }();
+};
+
+} // namespace detail
+
+// Deleter for the members of a group created by make_unique_group. Destroys
+// the object in place and frees the shared block once every member of the
+// group is gone. Resetting an owner to an object from outside its group is
+// undefined.
+class Group_delete
+{
+public:
+  constexpr Group_delete() noexcept = default;
+
+  constexpr explicit Group_delete(detail::Group_header *header) noexcept
+      : header_(header)
+  {
+  }
+
+  template <typename T>
+  void operator()(T *ptr) const noexcept
+  {
+    ptr->~T();
+    header_->release();
+  }
+
+private:
+  detail::Group_header *header_ = nullptr;
+};
+
+template <typename T>
+using Unique_group_ptr = Unique_ptr<T, Group_delete>;
+
+// Constraints: Children are nothrow default constructible and Parent is
+// constructible from a Unique_group_ptr to each child followed by args.
+// Effects: Allocates Parent and Children in one contiguous block,
+// value-initializes the children and constructs
+// Parent(Unique_group_ptr<Children>..., std::forward<Args>(args)...).
+// Returns: An owner of the parent. The block is freed when the parent and all
+// children are destroyed, in whatever order that happens.
+template <typename Parent, typename... Children, typename... Args>
+Unique_group_ptr<Parent> make_unique_group(Args &&...args) requires(
+    (std::is_nothrow_default_constructible_v<Children> && ...) &&
+    std::is_constructible_v<Parent, Unique_group_ptr<Children>..., Args...>)
+{
+  using Layout = detail::Group_layout<Parent, Children...>;
+
+  auto *block = static_cast<std::byte *>(
+      ::operator new(Layout::bytes, Layout::align));
+  auto *header = ::new (static_cast<void *>(block))
+      detail::Group_header{{Layout::count}, Layout::bytes, Layout::align};
+
+  // Drops the parent's reference if its constructor throws. The children are
+  // owned before any argument is converted, so they are released by the
+  // tuple or by the constructor's parameters, whichever holds them then.
+  Unique_ptr<detail::Group_header, detail::Group_release> guard(header);
+
+  auto *parent = [&]<std::size_t... I>(std::index_sequence<I...>) {
+    [[maybe_unused]] std::tuple<Unique_group_ptr<Children>...> children(
+        Unique_group_ptr<Children>(
+            ::new (static_cast<void *>(block + Layout::offsets[I + 1]))
+                Children(),
+            Group_delete(header))...);
+    return ::new (static_cast<void *>(block + Layout::offsets[0]))
+        Parent(std::move(std::get<I>(children))...,
+               std::forward<Args>(args)...);
+  }
+  (std::index_sequence_for<Children...>{});
+
+  guard.release();
+  return Unique_group_ptr<Parent>(parent, Group_delete(header));
+}
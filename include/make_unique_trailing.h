@@ -0,0 +1,203 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <span>
+
+#include "prefixed_layout.h"
+#include "unique_ptr.h"
+
+namespace detail
+{
+
+// Frees a block allocated by Trailing_delete<T, Elem>::allocate()
+template <typename D>
+struct Block_delete {
+  std::size_t bytes;
+
+  void operator()(std::byte *p) const noexcept
+  {
+    D::deallocate(p, bytes);
+  }
+};
+
+// Destroys n objects without freeing them
+template <typename T>
+struct Destroy_n {
+  std::size_t n;
+
+  void operator()(T *p) const noexcept
+  {
+    std::destroy_n(p, n);
+  }
+};
+
+} // namespace detail
+
+// Deleter for objects created by make_unique_trailing: destroys the T and its
+// trailing Elems and frees the block with a single sized deallocation.
+template <typename T, typename Elem>
+class Trailing_delete
+{
+public:
+  // Offset of the first Elem from the start of the block
+  static constexpr std::size_t offset =
+      (sizeof(T) + alignof(Elem) - 1) / alignof(Elem) * alignof(Elem);
+  static constexpr std::align_val_t alignment{
+      alignof(T) > alignof(Elem) ? alignof(T) : alignof(Elem)};
+  // The largest count whose block size doesn't overflow
+  static constexpr std::size_t max_count =
+      (std::numeric_limits<std::size_t>::max() - offset) / sizeof(Elem);
+
+  constexpr Trailing_delete() noexcept = default;
+
+  constexpr explicit Trailing_delete(std::size_t count) noexcept
+      : count_(count)
+  {
+  }
+
+  // Returns: The number of trailing Elems.
+  constexpr std::size_t count() const noexcept
+  {
+    return count_;
+  }
+
+  // Preconditions: count <= max_count.
+  // Returns: The size of a block holding a T and count Elems.
+  static constexpr std::size_t bytes(std::size_t count) noexcept
+  {
+    return offset + count * sizeof(Elem);
+  }
+
+  // Returns: A block of bytes, from the unaligned operator new unless the
+  // alignment needs the aligned one. The nothrow form returns nullptr if the
+  // allocation fails.
+  static void *allocate(std::size_t bytes)
+  {
+    return New::allocate(bytes);
+  }
+
+  static void *allocate(std::size_t bytes, std::nothrow_t) noexcept
+  {
+    return New::allocate(bytes, std::nothrow);
+  }
+
+  static void deallocate(void *p, std::size_t bytes) noexcept
+  {
+    New::deallocate(p, bytes);
+  }
+
+  // Returns: The trailing Elems of ptr.
+  static Elem *elements(T *ptr) noexcept
+  {
+    return std::launder(
+        reinterpret_cast<Elem *>(reinterpret_cast<std::byte *>(ptr) + offset));
+  }
+
+  void operator()(T *ptr) const noexcept
+  {
+    Elem *elems = elements(ptr);
+    ptr->~T();
+    std::destroy_n(elems, count_);
+    deallocate(ptr, bytes(count_));
+  }
+
+private:
+  using New = detail::Aligned_new<static_cast<std::size_t>(alignment)>;
+
+  std::size_t count_ = 0;
+};
+
+template <typename T, typename Elem>
+using Unique_trailing_ptr = Unique_ptr<T, Trailing_delete<T, Elem>>;
+
+namespace detail
+{
+
+template <typename T, typename Elem, bool Overwrite, bool Nothrow,
+          typename... Args>
+Unique_trailing_ptr<T, Elem> make_unique_trailing(std::size_t n,
+                                                  Args &&...args)
+{
+  using D = Trailing_delete<T, Elem>;
+
+  void *memory;
+  if constexpr (Nothrow) {
+    if (n > D::max_count) {
+      return {};
+    }
+    memory = D::allocate(D::bytes(n), std::nothrow);
+    if (memory == nullptr) {
+      return {};
+    }
+  } else {
+    if (n > D::max_count) {
+      throw std::bad_array_new_length();
+    }
+    memory = D::allocate(D::bytes(n));
+  }
+  Unique_ptr<std::byte, Block_delete<D>> block(
+      static_cast<std::byte *>(memory), Block_delete<D>{D::bytes(n)});
+
+  // Placement new into the block, the guards undo the steps on an exception
+  Elem *elems = reinterpret_cast<Elem *>(block.get() + D::offset);
+  if constexpr (Overwrite) {
+    std::uninitialized_default_construct_n(elems, n);
+  } else {
+    std::uninitialized_value_construct_n(elems, n);
+  }
+  Unique_ptr<Elem, Destroy_n<Elem>> elems_guard(elems, Destroy_n<Elem>{n});
+
+  T *ptr = ::new (static_cast<void *>(block.get()))
+      T(std::forward<Args>(args)...);
+
+  elems_guard.release();
+  block.release();
+  return Unique_trailing_ptr<T, Elem>(ptr, D(n));
+}
+
+} // namespace detail
+
+// Constraints: T and Elem are not array types.
+// Effects: Allocates one block holding T(std::forward<Args>(args)...) followed
+// by n value-initialized Elems.
+// Returns: An owner whose deleter destroys both and frees the block once.
+template <typename T, typename Elem, typename... Args>
+Unique_trailing_ptr<T, Elem> make_unique_trailing(std::size_t n,
+                                                  Args &&...args)
+    requires(!std::is_array_v<T> && !std::is_array_v<Elem>)
+{
+  return detail::make_unique_trailing<T, Elem, false, false>(
+      n, std::forward<Args>(args)...);
+}
+
+// As make_unique_trailing, but the Elems are default-initialized.
+template <typename T, typename Elem, typename... Args>
+Unique_trailing_ptr<T, Elem> make_unique_trailing_for_overwrite(std::size_t n,
+                                                                Args &&...args)
+    requires(!std::is_array_v<T> && !std::is_array_v<Elem>)
+{
+  return detail::make_unique_trailing<T, Elem, true, false>(
+      n, std::forward<Args>(args)...);
+}
+
+// As make_unique_trailing, but returns an empty owner if the allocation fails.
+template <typename T, typename Elem, typename... Args>
+Unique_trailing_ptr<T, Elem> make_unique_trailing_nothrow(std::size_t n,
+                                                          Args &&...args)
+    requires(!std::is_array_v<T> && !std::is_array_v<Elem>)
+{
+  return detail::make_unique_trailing<T, Elem, false, true>(
+      n, std::forward<Args>(args)...);
+}
+
+// Preconditions: up.get() != nullptr.
+// Returns: The trailing Elems of the object owned by up.
+template <typename T, typename Elem>
+std::span<Elem> trailing(const Unique_trailing_ptr<T, Elem> &up) noexcept
+{
+  return {Trailing_delete<T, Elem>::elements(up.get()),
+          up.get_deleter().count()};
+}
@@ -0,0 +1,261 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "prefixed_layout.h"
+#include "unique_ptr.h"
+
+namespace detail
+{
+
+// Shared by an observed object and its Weak_observers. Bit 0 of state is set
+// while the object is alive, the rest counts Observer_locks twice.
+struct Observer_block {
+  static constexpr std::uint32_t alive = 1;
+  static constexpr std::uint32_t pin = 2;
+
+  std::atomic<std::uint32_t> state{alive};
+  // The object and its observers
+  std::atomic<std::uint32_t> refs{1};
+
+  void acquire() noexcept
+  {
+    refs.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void release() noexcept
+  {
+    if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete this;
+    }
+  }
+
+  // Clears the alive bit and waits until no Observer_lock pins the object
+  void expire() noexcept
+  {
+    std::uint32_t s =
+        state.fetch_and(~alive, std::memory_order_acq_rel) & ~alive;
+    while (s != 0) {
+      state.wait(s, std::memory_order_acquire);
+      s = state.load(std::memory_order_acquire);
+    }
+  }
+};
+
+// Starts every block created by make_unique_observable. block is null until
+// the first Weak_observer is created.
+struct Observable_header {
+  std::atomic<Observer_block *> block{nullptr};
+};
+
+template <typename T>
+using Observable_layout = Prefixed_layout<Observable_header, T>;
+
+} // namespace detail
+
+// Deleter for objects created by make_unique_observable. Without observers it
+// only adds a load and a branch to the destruction. Otherwise it marks the
+// object dead before destroying it, after any Observer_lock in another thread
+// is gone.
+template <typename T>
+struct Observe_delete {
+  // Preconditions: ptr was returned by make_unique_observable<T>.
+  void operator()(T *ptr) const noexcept
+  {
+    using Layout = detail::Observable_layout<T>;
+    if (detail::Observer_block *block =
+            Layout::header(ptr)->block.load(std::memory_order_acquire)) {
+      block->expire();
+      block->release();
+    }
+    Layout::destroy(ptr);
+  }
+};
+
+// Owner of an object that Weak_observers can watch. Observe_delete is empty,
+// so the owner is still a single pointer.
+//
+// Observe_delete looks up the control block in the header that
+// make_unique_observable puts in front of the object. A plain new T has no
+// such header, so adopting it or passing it to reset() is undefined.
+template <typename T>
+using Unique_observable_ptr = Unique_ptr<T, Observe_delete<T>>;
+
+// Constraints: T is not an array type.
+// Effects: Allocates T(std::forward<Args>(args)...) behind a header with room
+// for a control block pointer.
+template <typename T, typename... Args>
+Unique_observable_ptr<T> make_unique_observable(Args &&...args)
+    requires(!std::is_array_v<T>)
+{
+  return Unique_observable_ptr<T>(
+      detail::Observable_layout<T>::create(std::forward<Args>(args)...));
+}
+
+template <typename T>
+class Weak_observer;
+
+// Keeps an observed object from being destroyed while it exists, the owner's
+// deleter waits for it. Borrows the control block of the Weak_observer it was
+// created from, which must outlive it.
+//
+// The wait is not reentrant: destroying the owner on a thread that holds a
+// lock on the same object never returns. Release the lock first.
+template <typename T>
+class Observer_lock
+{
+public:
+  Observer_lock(const Observer_lock &) = delete;
+  Observer_lock &operator=(const Observer_lock &) = delete;
+
+  ~Observer_lock()
+  {
+    if (ptr_ != nullptr &&
+        block_->state.fetch_sub(detail::Observer_block::pin,
+                                std::memory_order_release) ==
+            detail::Observer_block::pin) {
+      // Dead and this was the last pin, the deleter is waiting
+      block_->state.notify_all();
+    }
+  }
+
+  T *get() const noexcept
+  {
+    return ptr_;
+  }
+
+  T &operator*() const noexcept
+  {
+    return *ptr_;
+  }
+
+  T *operator->() const noexcept
+  {
+    return ptr_;
+  }
+
+  explicit operator bool() const noexcept
+  {
+    return ptr_ != nullptr;
+  }
+
+private:
+  friend class Weak_observer<T>;
+
+  Observer_lock(detail::Observer_block *block, T *ptr) noexcept
+      : block_(block), ptr_(ptr)
+  {
+  }
+
+  detail::Observer_block *block_;
+  T *ptr_;
+};
+
+// Notices when the object of a Unique_observable_ptr is destroyed. The first
+// observer of an object allocates its control block.
+template <typename T>
+class Weak_observer
+{
+public:
+  constexpr Weak_observer() noexcept = default;
+
+  // Effects: Observes the object of owner, if any. Creating observers of one
+  // object from several threads at once is fine.
+  // Postconditions: expired() if owner is empty or the control block could
+  // not be allocated.
+  explicit Weak_observer(const Unique_observable_ptr<T> &owner) noexcept
+  {
+    if (owner == nullptr) {
+      return;
+    }
+    auto &slot =
+        detail::Observable_layout<T>::header(owner.get())->block;
+    detail::Observer_block *block = slot.load(std::memory_order_acquire);
+    if (block == nullptr) {
+      // Counts the object and this observer from the start
+      auto *created = new (std::nothrow) detail::Observer_block{.refs{2}};
+      if (created == nullptr) {
+        return;
+      }
+      if (slot.compare_exchange_strong(block, created,
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_acquire)) {
+        block_ = created;
+        ptr_ = owner.get();
+        return;
+      }
+      delete created;
+    }
+    block->acquire();
+    block_ = block;
+    ptr_ = owner.get();
+  }
+
+  Weak_observer(const Weak_observer &other) noexcept
+      : block_(other.block_), ptr_(other.ptr_)
+  {
+    if (block_ != nullptr) {
+      block_->acquire();
+    }
+  }
+
+  Weak_observer(Weak_observer &&other) noexcept
+      : block_(std::exchange(other.block_, nullptr)),
+        ptr_(std::exchange(other.ptr_, nullptr))
+  {
+  }
+
+  Weak_observer &operator=(Weak_observer other) noexcept
+  {
+    std::swap(block_, other.block_);
+    std::swap(ptr_, other.ptr_);
+    return *this;
+  }
+
+  ~Weak_observer()
+  {
+    if (block_ != nullptr) {
+      block_->release();
+    }
+  }
+
+  // Returns: true if the object was destroyed or nothing is observed.
+  bool expired() const noexcept
+  {
+    return block_ == nullptr ||
+           (block_->state.load(std::memory_order_acquire) &
+            detail::Observer_block::alive) == 0;
+  }
+
+  // Returns: The object, or nullptr if it was destroyed. Only meaningful if
+  // the owner can't be destroyed concurrently, use lock() otherwise.
+  T *get() const noexcept
+  {
+    return expired() ? nullptr : ptr_;
+  }
+
+  // Returns: A lock that converts to false if the object was destroyed,
+  // otherwise one that keeps the object alive until it goes away.
+  Observer_lock<T> lock() const noexcept
+  {
+    if (block_ == nullptr) {
+      return {nullptr, nullptr};
+    }
+    // Pin first and check afterwards, a single read-modify-write
+    std::uint32_t s = block_->state.fetch_add(detail::Observer_block::pin,
+                                              std::memory_order_acquire);
+    if ((s & detail::Observer_block::alive) == 0) {
+      Observer_lock<T> unpin(block_, ptr_);
+      return {nullptr, nullptr};
+    }
+    return {block_, ptr_};
+  }
+
+private:
+  detail::Observer_block *block_ = nullptr;
+  T *ptr_ = nullptr;
+};
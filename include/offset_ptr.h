@@ -0,0 +1,110 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Self-relative pointer: stores the distance from its own address to the
+// pointee, so a structure that contains both stays valid wherever it is
+// mapped, e.g. in shared memory or a memory-mapped file. Meets the
+// Cpp17NullablePointer requirements and can be used as Unique_ptr's pointer
+// type through D::pointer.
+//
+// Copying recomputes the offset for the new location, so an Offset_ptr can
+// also live outside the mapping, it is then only meaningful in the process
+// that created it.
+template <typename T>
+class Offset_ptr
+{
+public:
+  using element_type = T;
+
+  constexpr Offset_ptr() noexcept = default;
+
+  constexpr Offset_ptr(std::nullptr_t) noexcept {}
+
+  Offset_ptr(T *ptr) noexcept
+  {
+    set(ptr);
+  }
+
+  Offset_ptr(const Offset_ptr &other) noexcept
+  {
+    set(other.get());
+  }
+
+  template <typename U>
+  Offset_ptr(const Offset_ptr<U> &other) noexcept
+      requires std::is_convertible_v<U *, T *>
+  {
+    set(other.get());
+  }
+
+  Offset_ptr &operator=(const Offset_ptr &other) noexcept
+  {
+    set(other.get());
+    return *this;
+  }
+
+  Offset_ptr &operator=(std::nullptr_t) noexcept
+  {
+    offset_ = null;
+    return *this;
+  }
+
+  T *get() const noexcept
+  {
+    if (offset_ == null) {
+      return nullptr;
+    }
+    return reinterpret_cast<T *>(reinterpret_cast<std::uintptr_t>(this) +
+                                 static_cast<std::uintptr_t>(offset_));
+  }
+
+  std::add_lvalue_reference_t<T> operator*() const noexcept
+  {
+    return *get();
+  }
+
+  T *operator->() const noexcept
+  {
+    return get();
+  }
+
+  explicit operator bool() const noexcept
+  {
+    return offset_ != null;
+  }
+
+  friend bool operator==(const Offset_ptr &x, const Offset_ptr &y) noexcept
+  {
+    return x.get() == y.get();
+  }
+
+  friend bool operator==(const Offset_ptr &x, std::nullptr_t) noexcept
+  {
+    return x.offset_ == null;
+  }
+
+  friend std::strong_ordering operator<=>(const Offset_ptr &x,
+                                          const Offset_ptr &y) noexcept
+  {
+    return std::compare_three_way()(x.get(), y.get());
+  }
+
+private:
+  // Points into the Offset_ptr itself, so it can never refer to a T
+  static constexpr std::ptrdiff_t null = 1;
+
+  void set(T *ptr) noexcept
+  {
+    offset_ = ptr == nullptr
+                  ? null
+                  : static_cast<std::ptrdiff_t>(
+                        reinterpret_cast<std::uintptr_t>(ptr) -
+                        reinterpret_cast<std::uintptr_t>(this));
+  }
+
+  std::ptrdiff_t offset_ = null;
+};
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "unique_ptr.h"
+
+namespace detail
+{
+
+template <typename T>
+struct Is_unique_ptr : std::false_type {
+};
+
+template <typename T, typename D>
+struct Is_unique_ptr<Unique_ptr<T, D>> : std::true_type {
+};
+
+// Whether the C API can write straight into the pointer stored in Smart
+template <typename Smart, typename Pointer, typename... Args>
+inline constexpr bool is_direct_out_v =
+    Is_unique_ptr<Smart>::value && sizeof...(Args) == 0 &&
+    std::is_same_v<Pointer, typename Smart::pointer>;
+
+// The only way into a Unique_ptr's stored pointer: hands its address to C
+// APIs that fill it
+struct Out_ptr_access {
+  template <typename T, typename D>
+  static typename Unique_ptr<T, D>::pointer *
+  address(Unique_ptr<T, D> &u) noexcept
+  {
+    return &u.pair_.first();
+  }
+};
+
+// Stores p in s, moving args into the constructor if there are any
+template <typename Smart, typename Pointer, typename... Args>
+void store_out(Smart &s, Pointer p, std::tuple<Args...> &args)
+{
+  using Smart_pointer = typename Smart::pointer;
+  if constexpr (sizeof...(Args) == 0) {
+    s.reset(static_cast<Smart_pointer>(p));
+  } else {
+    std::apply(
+        [&](Args &...a) {
+          s = Smart(static_cast<Smart_pointer>(p), std::move(a)...);
+        },
+        args);
+  }
+}
+
+} // namespace detail
+
+// Returned by out_ptr(), converts to Pointer* (and void**) for a C API that
+// creates an object. Args are the decayed types of the extra arguments, which
+// are stored by value. For a Unique_ptr without extra arguments the API writes
+// into the stored pointer, otherwise into a temporary that is stored in the
+// smart pointer when this goes away, at the end of the full expression.
+template <typename Smart, typename Pointer, typename... Args>
+class Out_ptr
+{
+public:
+  // Effects: Resets s, which stays empty if the API doesn't write.
+  explicit Out_ptr(Smart &s, Args... args) noexcept(
+      (std::is_nothrow_move_constructible_v<Args> && ...))
+      : s_(s), args_(std::move(args)...)
+  {
+    s.reset();
+  }
+
+  Out_ptr(const Out_ptr &) = delete;
+  Out_ptr &operator=(const Out_ptr &) = delete;
+
+  // Effects: Stores the written pointer in s if it isn't null.
+  ~Out_ptr()
+  {
+    if constexpr (!direct) {
+      if (p_ != nullptr) {
+        detail::store_out(s_, p_, args_);
+      }
+    }
+  }
+
+  operator Pointer *() const noexcept
+  {
+    return address();
+  }
+
+  // As std::out_ptr_t, for APIs that take void**
+  operator void **() const noexcept requires(!std::is_same_v<Pointer, void *>)
+  {
+    return reinterpret_cast<void **>(address());
+  }
+
+private:
+  static constexpr bool direct =
+      detail::is_direct_out_v<Smart, Pointer, Args...>;
+
+  Pointer *address() const noexcept
+  {
+    if constexpr (direct) {
+      return detail::Out_ptr_access::address(s_);
+    } else {
+      return &p_;
+    }
+  }
+
+  Smart &s_;
+  std::tuple<Args...> args_;
+  mutable Pointer p_{};
+};
+
+// Returned by inout_ptr(), converts to Pointer* (and void**) for a C API that
+// replaces an object, e.g. reallocates it. The API gets the owned pointer and
+// ownership of whatever it writes back. For a Unique_ptr without extra
+// arguments it writes into the stored pointer.
+template <typename Smart, typename Pointer, typename... Args>
+class Inout_ptr
+{
+public:
+  // Effects: Hands the owned pointer over to the API.
+  explicit Inout_ptr(Smart &s, Args... args) noexcept(
+      (std::is_nothrow_move_constructible_v<Args> && ...))
+      : s_(s), args_(std::move(args)...)
+  {
+    if constexpr (!direct) {
+      p_ = s.release();
+    }
+  }
+
+  Inout_ptr(const Inout_ptr &) = delete;
+  Inout_ptr &operator=(const Inout_ptr &) = delete;
+
+  // Effects: Stores the written pointer in s if it isn't null.
+  ~Inout_ptr()
+  {
+    if constexpr (!direct) {
+      if (p_ != nullptr) {
+        detail::store_out(s_, p_, args_);
+      }
+    }
+  }
+
+  operator Pointer *() const noexcept
+  {
+    return address();
+  }
+
+  operator void **() const noexcept requires(!std::is_same_v<Pointer, void *>)
+  {
+    return reinterpret_cast<void **>(address());
+  }
+
+private:
+  static constexpr bool direct =
+      detail::is_direct_out_v<Smart, Pointer, Args...>;
+
+  Pointer *address() const noexcept
+  {
+    if constexpr (direct) {
+      return detail::Out_ptr_access::address(s_);
+    } else {
+      return &p_;
+    }
+  }
+
+  Smart &s_;
+  std::tuple<Args...> args_;
+  mutable Pointer p_{};
+};
+
+// Returns: An adapter for passing s to a C API that writes a new object to a
+// Pointer*, Smart::pointer by default. args are passed on to Smart's
+// constructor along with the new pointer, e.g. a deleter.
+template <typename Pointer = void, typename Smart, typename... Args>
+auto out_ptr(Smart &s, Args &&...args) noexcept(
+    (std::is_nothrow_constructible_v<std::decay_t<Args>, Args> && ...))
+{
+  using P = std::conditional_t<std::is_void_v<Pointer>,
+                               typename Smart::pointer, Pointer>;
+  using Adapter = Out_ptr<Smart, P, std::decay_t<Args>...>;
+  return Adapter(s, std::forward<Args>(args)...);
+}
+
+// Returns: An adapter for passing s to a C API that takes the object through
+// a Pointer* and may replace it.
+template <typename Pointer = void, typename Smart, typename... Args>
+auto inout_ptr(Smart &s, Args &&...args) noexcept(
+    (std::is_nothrow_constructible_v<std::decay_t<Args>, Args> && ...))
+{
+  using P = std::conditional_t<std::is_void_v<Pointer>,
+                               typename Smart::pointer, Pointer>;
+  using Adapter = Inout_ptr<Smart, P, std::decay_t<Args>...>;
+  return Adapter(s, std::forward<Args>(args)...);
+}
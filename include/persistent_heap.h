@@ -0,0 +1,304 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "segment_heap.h"
+#include "shm_segment.h"
+#include "unique_ptr.h"
+
+template <typename T>
+using Unique_persistent_ptr = Unique_ptr<T, Segment_delete<T>>;
+
+namespace detail
+{
+
+// A file descriptor as a Cpp17NullablePointer, -1 is null
+class File_handle
+{
+public:
+  constexpr File_handle() noexcept = default;
+
+  constexpr File_handle(std::nullptr_t) noexcept {}
+
+  constexpr explicit File_handle(int fd) noexcept : fd_(fd) {}
+
+  constexpr int get() const noexcept
+  {
+    return fd_;
+  }
+
+  explicit constexpr operator bool() const noexcept
+  {
+    return fd_ != -1;
+  }
+
+  friend constexpr bool operator==(File_handle,
+                                   File_handle) noexcept = default;
+
+  friend constexpr bool operator==(File_handle x, std::nullptr_t) noexcept
+  {
+    return x.fd_ == -1;
+  }
+
+private:
+  int fd_ = -1;
+};
+
+struct File_close {
+  using pointer = File_handle;
+
+  void operator()(File_handle file) const noexcept
+  {
+    ::close(file.get());
+  }
+};
+
+using Unique_file = Unique_ptr<File_handle, File_close>;
+
+// The first page of a persistent heap file, the Segment_heap follows it
+struct Persistent_header {
+  // Persistent_heap::formatting while the file is being formatted,
+  // Persistent_heap::magic once that finished
+  std::uint64_t magic;
+  // Set while a process has the file open, still set after a crash
+  std::uint64_t in_use;
+};
+
+} // namespace detail
+
+// A Segment_heap in a memory-mapped file. Objects built in it with
+// make_unique_persistent and linked through Unique_persistent_ptr members
+// survive a restart: reopening the file gives back the published root
+// without rebuilding anything.
+//
+// Publication is crash-consistent: the whole file is synced before the root
+// offset is stored, and the header again after, so the root in the file is
+// either the old or the new one and everything reachable from it is on
+// disk. Objects reachable from a published root must not be modified, build
+// a new root and publish that instead.
+//
+// The allocator's free list and block headers are not: the kernel may write
+// back any of its pages between two syncs, so after a crash they can be in a
+// state that never existed. A file that was not closed cleanly is therefore
+// opened recovered(), on a private copy-on-write mapping with an empty free
+// list. The published root can be read, make_unique_persistent returns empty
+// owners and publish() fails. Destroying owners of objects in the heap only
+// changes the private copy, nothing reaches the file. Copy what is needed
+// into a new heap and replace the file. Allocations that are still owned
+// when a heap is closed cleanly are leaked.
+//
+// Only one process may have the file open at a time, open() takes an
+// exclusive flock for the lifetime of the heap. Failures are reported by
+// returning a heap that converts to false.
+class Persistent_heap
+{
+public:
+  static constexpr std::uint64_t magic = 0x5045525348454150; // "PERSHEAP"
+  static constexpr std::uint64_t formatting = 0x5045525346524d54; // "PERSFRMT"
+
+  Persistent_heap() noexcept = default;
+
+  Persistent_heap(Persistent_heap &&other) noexcept
+      : lock_(std::move(other.lock_)), mapping_(std::move(other.mapping_)),
+        heap_(std::exchange(other.heap_, Segment_heap())),
+        recovered_(std::exchange(other.recovered_, false))
+  {
+  }
+
+  Persistent_heap &operator=(Persistent_heap other) noexcept
+  {
+    std::swap(lock_, other.lock_);
+    std::swap(mapping_, other.mapping_);
+    std::swap(heap_, other.heap_);
+    std::swap(recovered_, other.recovered_);
+    return *this;
+  }
+
+  // Effects: Syncs the file and marks it closed cleanly, unless the heap is
+  // recovered().
+  ~Persistent_heap()
+  {
+    if (heap_ && !recovered_ && sync()) {
+      header()->in_use = 0;
+      ::msync(mapping_.get(), page_size(), MS_SYNC);
+    }
+  }
+
+  // Effects: Maps the heap in the file path, creating it with size bytes if
+  // it does not exist or is empty, or finishing the formatting if that was
+  // interrupted. Fails if another process has the file open, or if it holds
+  // anything but a heap of the current Segment_heap::version.
+  static Persistent_heap open(const char *path, std::size_t size) noexcept
+  {
+    Persistent_heap persistent;
+    persistent.lock_ = detail::Unique_file(
+        detail::File_handle(::open(path, O_RDWR | O_CREAT, 0600)));
+    const int fd = persistent.lock_.get().get();
+    if (fd == -1 || ::flock(fd, LOCK_EX | LOCK_NB) == -1) {
+      return Persistent_heap();
+    }
+    struct stat st;
+    if (::fstat(fd, &st) == -1) {
+      return Persistent_heap();
+    }
+
+    // A new file is marked durably before it grows, so that a file which
+    // was being formatted can be told apart from one that isn't a heap
+    detail::Persistent_header first{};
+    constexpr auto header_size = static_cast<ssize_t>(sizeof(first));
+    if (st.st_size == 0) {
+      first.magic = formatting;
+      if (::pwrite(fd, &first, sizeof(first), 0) != header_size ||
+          ::fsync(fd) == -1) {
+        return Persistent_heap();
+      }
+    } else if (::pread(fd, &first, sizeof(first), 0) != header_size) {
+      return Persistent_heap();
+    }
+    const bool unfinished = first.magic == formatting;
+    const bool recovered = first.magic == magic && first.in_use != 0;
+    auto bytes = static_cast<std::size_t>(st.st_size);
+    if (unfinished && bytes < size) {
+      if (::ftruncate(fd, static_cast<off_t>(size)) == -1) {
+        return Persistent_heap();
+      }
+      bytes = size;
+    }
+
+    // The lock stays with fd, the mapping gets its own descriptor
+    persistent.mapping_ = detail::map_file(
+        ::dup(fd), bytes, recovered ? MAP_PRIVATE : MAP_SHARED);
+    const std::size_t mapped = persistent.mapping_.get_deleter().size();
+    if (persistent.mapping_ == nullptr ||
+        mapped < page_size() + sizeof(detail::Segment_header)) {
+      return Persistent_heap();
+    }
+    detail::Persistent_header *header = persistent.header();
+    void *base = static_cast<std::byte *>(persistent.mapping_.get()) +
+                 page_size();
+
+    if (unfinished) {
+      persistent.heap_ = Segment_heap::format(base, mapped - page_size());
+      header->in_use = 1;
+      if (!persistent.heap_ || !persistent.sync()) {
+        return Persistent_heap();
+      }
+      std::atomic_ref(header->magic).store(magic, std::memory_order_release);
+    } else if (header->magic == magic) {
+      persistent.heap_ = Segment_heap::attach(base);
+    }
+    if (!persistent.heap_) {
+      return Persistent_heap();
+    }
+    if (recovered) {
+      // The free list can't be trusted, blocks freed in the copy start a
+      // new one
+      persistent.recovered_ = true;
+      persistent.heap_.header()->free = 0;
+    } else {
+      header->in_use = 1;
+      if (::msync(header, page_size(), MS_SYNC) != 0) {
+        return Persistent_heap();
+      }
+    }
+    // Whoever held it last is gone, the flock says so
+    persistent.heap_.reset_lock();
+    return persistent;
+  }
+
+  explicit operator bool() const noexcept
+  {
+    return static_cast<bool>(heap_);
+  }
+
+  // Returns: true if the file was not closed cleanly the last time. The
+  // heap is then a private copy of the file, see the class comment.
+  bool recovered() const noexcept
+  {
+    return recovered_;
+  }
+
+  // Returns: The Segment_heap in the file. For a recovered() heap it is in
+  // the private copy, nothing done with it reaches the file.
+  Segment_heap heap() const noexcept
+  {
+    return heap_;
+  }
+
+  // Returns: The published root, or nullptr if there is none.
+  template <typename T>
+  T *root() const noexcept
+  {
+    return static_cast<T *>(heap_.root());
+  }
+
+  // Effects: Durably makes root the root object and hands the previous root
+  // back through root, for the caller to destroy or keep. root must have
+  // been allocated in this heap and must be of the type root() is read as.
+  // Returns: false if the heap is recovered() or syncing failed, root is
+  // unchanged in that case and the root in the file is the previous one.
+  template <typename T>
+  bool publish(Unique_persistent_ptr<T> &root) noexcept
+  {
+    if (recovered_ || !sync()) {
+      return false;
+    }
+    T *previous = this->root<T>();
+    heap_.set_root(root.get().get());
+    if (::msync(heap_.header(), page_size(), MS_SYNC) != 0) {
+      heap_.set_root(previous);
+      return false;
+    }
+    root.release();
+    root = Unique_persistent_ptr<T>(previous, Segment_delete<T>(heap_));
+    return true;
+  }
+
+  // Effects: Writes all modified pages of the file to disk.
+  bool sync() const noexcept
+  {
+    return ::msync(mapping_.get(), mapping_.get_deleter().size(), MS_SYNC) ==
+           0;
+  }
+
+private:
+  static std::size_t page_size() noexcept
+  {
+    // msync works on whole pages, each header gets one
+    return static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  }
+
+  detail::Persistent_header *header() const noexcept
+  {
+    return static_cast<detail::Persistent_header *>(mapping_.get());
+  }
+
+  // Declared first, the file stays locked until it is unmapped
+  detail::Unique_file lock_;
+  detail::Unique_mapping mapping_;
+  Segment_heap heap_;
+  bool recovered_ = false;
+};
+
+// Constraints: T is not an array type.
+// Returns: A Unique_ptr owning a T constructed from args in heap, or an empty
+// owner if the heap is out of space or recovered().
+template <typename T, typename... Args>
+Unique_persistent_ptr<T> make_unique_persistent(const Persistent_heap &heap,
+                                                Args &&...args) requires(
+    !std::is_array_v<T>)
+{
+  if (heap.recovered()) {
+    return Unique_persistent_ptr<T>(nullptr, Segment_delete<T>(heap.heap()));
+  }
+  return make_unique_segment<T>(heap.heap(), std::forward<Args>(args)...);
+}
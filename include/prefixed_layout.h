@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "unique_ptr.h"
+
+namespace detail
+{
+
+// The global operator new and delete for blocks aligned to Align. The aligned
+// forms are only called if Align exceeds the default new alignment, the
+// unaligned ones are cheaper.
+template <std::size_t Align>
+struct Aligned_new {
+  static constexpr bool over_aligned =
+      Align > __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+  static constexpr std::align_val_t align{Align};
+
+  static void *allocate(std::size_t bytes)
+  {
+    if constexpr (over_aligned) {
+      return ::operator new(bytes, align);
+    } else {
+      return ::operator new(bytes);
+    }
+  }
+
+  static void *allocate(std::size_t bytes, std::nothrow_t) noexcept
+  {
+    if constexpr (over_aligned) {
+      return ::operator new(bytes, align, std::nothrow);
+    } else {
+      return ::operator new(bytes, std::nothrow);
+    }
+  }
+
+  static void deallocate(void *p, std::size_t bytes) noexcept
+  {
+    if constexpr (over_aligned) {
+      ::operator delete(p, bytes, align);
+    } else {
+      ::operator delete(p, bytes);
+    }
+  }
+};
+
+// A block holding a Header followed by a T, padded so that the T is aligned.
+// Owners point at the T and find the Header and the start of the block from
+// it.
+template <typename Header, typename T>
+struct Prefixed_layout {
+  static_assert(std::is_nothrow_default_constructible_v<Header>,
+                "create() has no guard for a throwing Header");
+
+  // Offset of the object from the start of the block
+  static constexpr std::size_t offset =
+      (sizeof(Header) + alignof(T) - 1) / alignof(T) * alignof(T);
+  static constexpr std::size_t bytes = offset + sizeof(T);
+
+  using New = Aligned_new<(alignof(Header) > alignof(T) ? alignof(Header)
+                                                        : alignof(T))>;
+
+  static void deallocate(void *p) noexcept
+  {
+    New::deallocate(p, bytes);
+  }
+
+  static std::byte *start(T *ptr) noexcept
+  {
+    return reinterpret_cast<std::byte *>(ptr) - offset;
+  }
+
+  static Header *header(T *ptr) noexcept
+  {
+    return std::launder(reinterpret_cast<Header *>(start(ptr)));
+  }
+
+  // Effects: Allocates a block and constructs T(std::forward<Args>(args)...)
+  // and a value-initialized Header in it. The block is freed if the T throws.
+  // Returns: The T.
+  template <typename... Args>
+  static T *create(Args &&...args)
+  {
+    struct Free {
+      void operator()(std::byte *p) const noexcept
+      {
+        deallocate(p);
+      }
+    };
+    Unique_ptr<std::byte, Free> block(
+        static_cast<std::byte *>(New::allocate(bytes)));
+
+    T *ptr = ::new (static_cast<void *>(block.get() + offset))
+        T(std::forward<Args>(args)...);
+    ::new (static_cast<void *>(block.get())) Header();
+    block.release();
+    return ptr;
+  }
+
+  // Effects: Destroys the T and the Header and frees the block.
+  static void destroy(T *ptr) noexcept
+  {
+    std::byte *p = start(ptr);
+    Header *h = header(ptr);
+    ptr->~T();
+    h->~Header();
+    deallocate(p);
+  }
+};
+
+} // namespace detail
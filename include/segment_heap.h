@@ -0,0 +1,339 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <pthread.h>
+
+#include "offset_ptr.h"
+#include "unique_ptr.h"
+
+namespace detail
+{
+
+// Lives at the start of the memory a Segment_heap manages. Everything in it
+// is an offset from the header, so the heap can be mapped anywhere.
+struct Segment_header {
+  std::uint64_t magic;
+  std::uint64_t version;
+  std::uint64_t size;
+  // First block of the address ordered free list, 0 if there is none
+  std::uint64_t free;
+  // Root object, 0 if none was set
+  std::atomic<std::uint64_t> root;
+  pthread_mutex_t mutex;
+};
+
+// Every allocation is preceded by its block header. next is only meaningful
+// while the block is on the free list.
+struct Segment_block {
+  std::uint64_t size;
+  std::uint64_t next;
+};
+
+struct Segment_unlock {
+  void operator()(pthread_mutex_t *mutex) const noexcept
+  {
+    pthread_mutex_unlock(mutex);
+  }
+};
+
+} // namespace detail
+
+template <typename T>
+class Segment_delete;
+
+// First-fit allocator over a caller-provided block of memory, typically a
+// shared or file-backed mapping. Free blocks are kept in address order and
+// merged with their neighbours. A process-shared robust mutex serializes
+// allocation between all processes that map the memory.
+//
+// Segment_heap itself is just a handle to the header: copying it is cheap and
+// const only means the handle is not reseated.
+class Segment_heap
+{
+public:
+  static constexpr std::uint64_t magic = 0x5345474d48454150; // "SEGMHEAP"
+  static constexpr std::uint64_t version = 1;
+  static constexpr std::size_t alignment = alignof(std::max_align_t);
+
+  constexpr Segment_heap() noexcept = default;
+
+  // Effects: Initializes an empty heap in the size bytes at base, which must
+  // be aligned to alignment.
+  // Returns: A handle to the heap, or an empty handle if size is too small.
+  static Segment_heap format(void *base, std::size_t size) noexcept
+  {
+    if (size < blocks_offset + min_block) {
+      return Segment_heap();
+    }
+
+    auto *header = ::new (base) detail::Segment_header{};
+    header->version = version;
+    header->size = size;
+    header->free = blocks_offset;
+    auto *first = block_at(header, blocks_offset);
+    first->size = (size - blocks_offset) / alignment * alignment;
+    first->next = 0;
+    init_mutex(header);
+    // Written last, attach() does not accept a half formatted heap
+    std::atomic_ref(header->magic).store(magic, std::memory_order_release);
+    return Segment_heap(header);
+  }
+
+  // Returns: A handle to the heap formatted at base, or an empty handle if
+  // base does not hold a heap of this version.
+  static Segment_heap attach(void *base) noexcept
+  {
+    auto *header = static_cast<detail::Segment_header *>(base);
+    if (std::atomic_ref(header->magic).load(std::memory_order_acquire) !=
+            magic ||
+        header->version != version) {
+      return Segment_heap();
+    }
+    return Segment_heap(header);
+  }
+
+  // Effects: Reinitializes the lock, e.g. after reopening a heap in a file
+  // whose last user did not shut down cleanly.
+  // Preconditions: No other process or thread uses the heap.
+  void reset_lock() const noexcept
+  {
+    init_mutex(header_);
+  }
+
+  explicit operator bool() const noexcept
+  {
+    return header_ != nullptr;
+  }
+
+  detail::Segment_header *header() const noexcept
+  {
+    return header_;
+  }
+
+  // Returns: The number of bytes managed, including the header.
+  std::size_t size() const noexcept
+  {
+    return header_->size;
+  }
+
+  // Returns: size bytes aligned to alignment, or nullptr if no free block is
+  // large enough.
+  void *allocate(std::size_t size) const noexcept
+  {
+    if (size > header_->size) {
+      return nullptr;
+    }
+    const std::uint64_t need = std::max<std::uint64_t>(
+        (sizeof(detail::Segment_block) + size + alignment - 1) / alignment *
+            alignment,
+        min_block);
+
+    auto lock = this->lock();
+    std::uint64_t *link = &header_->free;
+    while (*link != 0) {
+      auto *block = block_at(header_, *link);
+      if (block->size >= need) {
+        if (block->size - need >= min_block) {
+          auto *rest = block_at(header_, *link + need);
+          rest->size = block->size - need;
+          rest->next = block->next;
+          block->size = need;
+          *link += need;
+        } else {
+          *link = block->next;
+        }
+        return block + 1;
+      }
+      link = &block->next;
+    }
+    return nullptr;
+  }
+
+  // Preconditions: ptr was returned by allocate() on this heap and has not
+  // been deallocated since, or is nullptr.
+  void deallocate(void *ptr) const noexcept
+  {
+    if (ptr == nullptr) {
+      return;
+    }
+    auto *block = static_cast<detail::Segment_block *>(ptr) - 1;
+    const std::uint64_t offset = offset_of(block);
+
+    auto lock = this->lock();
+    detail::Segment_block *prev = nullptr;
+    std::uint64_t *link = &header_->free;
+    while (*link != 0 && *link < offset) {
+      prev = block_at(header_, *link);
+      link = &prev->next;
+    }
+
+    block->next = *link;
+    *link = offset;
+    if (block->next != 0 && offset + block->size == block->next) {
+      auto *next = block_at(header_, block->next);
+      block->size += next->size;
+      block->next = next->next;
+    }
+    if (prev != nullptr && offset_of(prev) + prev->size == offset) {
+      prev->size += block->size;
+      prev->next = block->next;
+    }
+  }
+
+  // Returns: The root object, or nullptr if none was set.
+  void *root() const noexcept
+  {
+    const std::uint64_t offset =
+        header_->root.load(std::memory_order_acquire);
+    return offset == 0 ? nullptr
+                       : reinterpret_cast<std::byte *>(header_) + offset;
+  }
+
+  // Effects: Makes ptr, which must point into the heap or be nullptr, the
+  // root object. The previous root is not destroyed.
+  void set_root(void *ptr) const noexcept
+  {
+    header_->root.store(ptr == nullptr ? 0 : offset_of(ptr),
+                        std::memory_order_release);
+  }
+
+  // Returns: The number of free bytes, including block headers.
+  std::size_t free_bytes() const noexcept
+  {
+    auto lock = this->lock();
+    std::size_t bytes = 0;
+    for (std::uint64_t offset = header_->free; offset != 0;) {
+      auto *block = block_at(header_, offset);
+      bytes += block->size;
+      offset = block->next;
+    }
+    return bytes;
+  }
+
+private:
+  template <typename T>
+  friend class Segment_delete;
+
+  static constexpr std::uint64_t blocks_offset =
+      (sizeof(detail::Segment_header) + alignment - 1) / alignment * alignment;
+  static constexpr std::uint64_t min_block = 2 * sizeof(detail::Segment_block);
+
+  explicit Segment_heap(detail::Segment_header *header) noexcept
+      : header_(header)
+  {
+  }
+
+  static detail::Segment_block *block_at(detail::Segment_header *header,
+                                         std::uint64_t offset) noexcept
+  {
+    return reinterpret_cast<detail::Segment_block *>(
+        reinterpret_cast<std::byte *>(header) + offset);
+  }
+
+  std::uint64_t offset_of(const void *ptr) const noexcept
+  {
+    return static_cast<std::uint64_t>(static_cast<const std::byte *>(ptr) -
+                                      reinterpret_cast<std::byte *>(header_));
+  }
+
+  static void init_mutex(detail::Segment_header *header) noexcept
+  {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&header->mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+  }
+
+  Unique_ptr<pthread_mutex_t, detail::Segment_unlock> lock() const noexcept
+  {
+    // A process died holding the lock. The free list is updated in a few
+    // stores, so it is taken over as is.
+    if (pthread_mutex_lock(&header_->mutex) == EOWNERDEAD) {
+      pthread_mutex_consistent(&header_->mutex);
+    }
+    return Unique_ptr<pthread_mutex_t, detail::Segment_unlock>(
+        &header_->mutex);
+  }
+
+  detail::Segment_header *header_ = nullptr;
+};
+
+// Deleter for objects allocated in a Segment_heap. The pointer and the
+// reference to the heap are both Offset_ptrs, so a Unique_ptr using this
+// deleter can itself be stored in the heap and used from any process that
+// maps it.
+template <typename T>
+class Segment_delete
+{
+public:
+  using pointer = Offset_ptr<T>;
+
+  Segment_delete() noexcept = default;
+
+  explicit Segment_delete(Segment_heap heap) noexcept : header_(heap.header())
+  {
+  }
+
+  Segment_heap heap() const noexcept
+  {
+    return Segment_heap(header_.get());
+  }
+
+  void operator()(pointer ptr) const noexcept
+  {
+    static_assert(sizeof(T) > 0, "can't delete an incomplete type");
+    T *raw = ptr.get();
+    raw->~T();
+    heap().deallocate(raw);
+  }
+
+private:
+  Offset_ptr<detail::Segment_header> header_;
+};
+
+template <typename T>
+using Unique_segment_ptr = Unique_ptr<T, Segment_delete<T>>;
+
+namespace detail
+{
+
+struct Segment_free {
+  Segment_heap heap;
+
+  void operator()(void *ptr) const noexcept
+  {
+    heap.deallocate(ptr);
+  }
+};
+
+} // namespace detail
+
+// Constraints: T is not an array type.
+// Returns: A Unique_ptr owning a T constructed from args in heap, or an empty
+// owner if the heap is out of space.
+template <typename T, typename... Args>
+Unique_segment_ptr<T> make_unique_segment(Segment_heap heap,
+                                          Args &&...args) requires(
+    !std::is_array_v<T>)
+{
+  static_assert(alignof(T) <= Segment_heap::alignment,
+                "over-aligned types are not supported");
+  Unique_ptr<void, detail::Segment_free> mem(heap.allocate(sizeof(T)),
+                                             detail::Segment_free{heap});
+  if (mem == nullptr) {
+    return Unique_segment_ptr<T>(nullptr, Segment_delete<T>(heap));
+  }
+  T *ptr = ::new (mem.get()) T(std::forward<Args>(args)...);
+  mem.release();
+  return Unique_segment_ptr<T>(ptr, Segment_delete<T>(heap));
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "prefixed_layout.h"
+#include "unique_ptr.h"
+
+namespace detail
+{
+
+// Room for a shared_ptr control block with an empty deleter and a one-pointer
+// allocator: a vtable pointer, two counts, the allocator and the pointer in
+// libstdc++, the counts are a long each in libc++. share() builds the control
+// block in it.
+struct Shareable_reserve {
+  std::byte bytes[5 * sizeof(void *)];
+};
+
+template <typename T>
+using Shareable_layout = Prefixed_layout<Shareable_reserve, T>;
+
+// The deleter of a shared T, the block is freed with the control block
+template <typename T>
+struct Shareable_destroy {
+  void operator()(T *ptr) const noexcept
+  {
+    ptr->~T();
+  }
+};
+
+// Hands the reserve of a block to the control block of a shared_ptr.
+// Deallocating the control block frees the whole block, the T is destroyed
+// by then.
+template <typename U, typename T>
+struct Share_allocator {
+  using value_type = U;
+
+  template <typename V>
+  struct rebind {
+    using other = Share_allocator<V, T>;
+  };
+
+  explicit Share_allocator(std::byte *start) noexcept : start(start) {}
+
+  template <typename V>
+  Share_allocator(const Share_allocator<V, T> &other) noexcept
+      : start(other.start)
+  {
+  }
+
+  U *allocate(std::size_t n) noexcept
+  {
+    static_assert(sizeof(U) <= sizeof(Shareable_reserve) &&
+                      alignof(U) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+                  "the shared_ptr control block does not fit the reserve");
+    (void)n;
+    return reinterpret_cast<U *>(start);
+  }
+
+  void deallocate(U *, std::size_t) noexcept
+  {
+    Shareable_layout<T>::deallocate(start);
+  }
+
+  template <typename V>
+  bool operator==(const Share_allocator<V, T> &other) const noexcept
+  {
+    return start == other.start;
+  }
+
+  std::byte *start;
+};
+
+} // namespace detail
+
+// Deleter for objects created by make_unique_shareable that were not shared.
+template <typename T>
+struct Shareable_delete {
+  // Preconditions: ptr was returned by make_unique_shareable<T>.
+  void operator()(T *ptr) const noexcept
+  {
+    detail::Shareable_layout<T>::destroy(ptr);
+  }
+};
+
+// Owner that share() turns into a shared_ptr without allocating. Until then
+// it behaves like a Unique_ptr<T>.
+//
+// share() builds the control block in the reserve that make_unique_shareable
+// allocates in front of the object, and Shareable_delete frees the block
+// from the reserve's address. Pointers from anywhere else lack the reserve;
+// an owner must never adopt one, in its constructor or in reset().
+template <typename T>
+using Unique_shareable_ptr = Unique_ptr<T, Shareable_delete<T>>;
+
+// Constraints: T is not an array type.
+// Effects: Allocates T(std::forward<Args>(args)...) together with room for a
+// shared_ptr control block.
+template <typename T, typename... Args>
+Unique_shareable_ptr<T> make_unique_shareable(Args &&...args)
+    requires(!std::is_array_v<T>)
+{
+  return Unique_shareable_ptr<T>(
+      detail::Shareable_layout<T>::create(std::forward<Args>(args)...));
+}
+
+// Effects: Transfers the object of up to a shared_ptr whose control block is
+// placed in the reserved space, nothing is allocated.
+// Postconditions: up.get() == nullptr.
+// Returns: The shared_ptr, empty if up was.
+template <typename T>
+std::shared_ptr<T> share(Unique_shareable_ptr<T> &&up) noexcept
+{
+  if (up == nullptr) {
+    return {};
+  }
+  T *ptr = up.release();
+  return std::shared_ptr<T>(
+      ptr, detail::Shareable_destroy<T>{},
+      detail::Share_allocator<T, T>(detail::Shareable_layout<T>::start(ptr)));
+}
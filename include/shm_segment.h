@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "segment_heap.h"
+#include "unique_ptr.h"
+
+namespace detail
+{
+
+class Unmap_delete
+{
+public:
+  constexpr Unmap_delete() noexcept = default;
+
+  constexpr explicit Unmap_delete(std::size_t size) noexcept : size_(size)
+  {
+  }
+
+  constexpr std::size_t size() const noexcept
+  {
+    return size_;
+  }
+
+  void operator()(void *ptr) const noexcept
+  {
+    ::munmap(ptr, size_);
+  }
+
+private:
+  std::size_t size_ = 0;
+};
+
+using Unique_mapping = Unique_ptr<void, Unmap_delete>;
+
+// Returns: A read-write mapping of the first size bytes of fd, with flags
+// MAP_SHARED or MAP_PRIVATE, or an empty owner on failure. fd is closed
+// either way.
+inline Unique_mapping map_file(int fd, std::size_t size, int flags) noexcept
+{
+  void *ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, fd, 0);
+  ::close(fd);
+  if (ptr == MAP_FAILED) {
+    return Unique_mapping();
+  }
+  return Unique_mapping(ptr, Unmap_delete(size));
+}
+
+inline Unique_mapping map_shared(int fd, std::size_t size) noexcept
+{
+  return map_file(fd, size, MAP_SHARED);
+}
+
+} // namespace detail
+
+// Deleter for objects in a shared memory segment
+template <typename T>
+using Shm_delete = Segment_delete<T>;
+
+template <typename T>
+using Unique_shm_ptr = Unique_ptr<T, Shm_delete<T>>;
+
+// A POSIX shared memory object mapped into this process, with a Segment_heap
+// in it. Every process maps the segment at a different address, objects in it
+// must refer to each other through Offset_ptrs, e.g. Unique_shm_ptr members.
+//
+// Failures are reported by returning a segment that converts to false.
+class Shm_segment
+{
+public:
+  Shm_segment() noexcept = default;
+
+  // Effects: Creates the shared memory object name of size bytes and formats
+  // a heap in it. Fails if the object already exists.
+  static Shm_segment create(const char *name, std::size_t size) noexcept
+  {
+    const int fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd == -1) {
+      return Shm_segment();
+    }
+    if (::ftruncate(fd, static_cast<off_t>(size)) == -1) {
+      ::close(fd);
+      ::shm_unlink(name);
+      return Shm_segment();
+    }
+    Shm_segment segment;
+    segment.mapping_ = detail::map_shared(fd, size);
+    if (segment.mapping_ != nullptr) {
+      segment.heap_ = Segment_heap::format(segment.mapping_.get(), size);
+    }
+    if (!segment) {
+      ::shm_unlink(name);
+      return Shm_segment();
+    }
+    return segment;
+  }
+
+  // Effects: Maps the existing shared memory object name.
+  static Shm_segment open(const char *name) noexcept
+  {
+    const int fd = ::shm_open(name, O_RDWR, 0);
+    if (fd == -1) {
+      return Shm_segment();
+    }
+    struct stat st;
+    if (::fstat(fd, &st) == -1) {
+      ::close(fd);
+      return Shm_segment();
+    }
+    Shm_segment segment;
+    segment.mapping_ =
+        detail::map_shared(fd, static_cast<std::size_t>(st.st_size));
+    if (segment.mapping_ != nullptr) {
+      segment.heap_ = Segment_heap::attach(segment.mapping_.get());
+    }
+    return segment;
+  }
+
+  // Effects: Removes the name, the memory stays valid until the last
+  // mapping is gone.
+  static bool remove(const char *name) noexcept
+  {
+    return ::shm_unlink(name) == 0;
+  }
+
+  explicit operator bool() const noexcept
+  {
+    return static_cast<bool>(heap_);
+  }
+
+  Segment_heap heap() const noexcept
+  {
+    return heap_;
+  }
+
+  template <typename T>
+  T *root() const noexcept
+  {
+    return static_cast<T *>(heap_.root());
+  }
+
+  void set_root(void *ptr) noexcept
+  {
+    heap_.set_root(ptr);
+  }
+
+private:
+  detail::Unique_mapping mapping_;
+  Segment_heap heap_;
+};
+
+// Constraints: T is not an array type.
+// Returns: A Unique_ptr owning a T constructed from args in segment, or an
+// empty owner if the segment is out of space.
+template <typename T, typename... Args>
+Unique_shm_ptr<T> make_unique_shm(const Shm_segment &segment,
+                                  Args &&...args) requires(!std::is_array_v<T>)
+{
+  return make_unique_segment<T>(segment.heap(), std::forward<Args>(args)...);
+}
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "unique_ptr.h"
+
+template <typename T>
+class Slot_map;
+
+// Non-owning handle to a value in a Slot_map: the slot index and the slot's
+// generation when the value was inserted. Handles are cheap to copy and can
+// detect that their value was erased, get() then returns nullptr. Meets the
+// Cpp17NullablePointer requirements, a handle without a map is null.
+template <typename T>
+class Slot_handle
+{
+public:
+  constexpr Slot_handle() noexcept = default;
+
+  constexpr Slot_handle(std::nullptr_t) noexcept {}
+
+  constexpr Slot_handle(Slot_map<T> *map, std::uint32_t index,
+                        std::uint32_t generation) noexcept
+      : map_(map), index_(index), generation_(generation)
+  {
+  }
+
+  // Returns: The value, or nullptr if the handle is null or the value was
+  // erased.
+  T *get() const noexcept
+  {
+    return map_ == nullptr ? nullptr : map_->find(*this);
+  }
+
+  // Preconditions: The value was not erased.
+  T &operator*() const noexcept
+  {
+    return *get();
+  }
+
+  T *operator->() const noexcept
+  {
+    return get();
+  }
+
+  // Returns: true if the handle is null or the value was erased.
+  bool expired() const noexcept
+  {
+    return get() == nullptr;
+  }
+
+  explicit operator bool() const noexcept
+  {
+    return map_ != nullptr;
+  }
+
+  constexpr Slot_map<T> *map() const noexcept
+  {
+    return map_;
+  }
+
+  constexpr std::uint32_t index() const noexcept
+  {
+    return index_;
+  }
+
+  constexpr std::uint32_t generation() const noexcept
+  {
+    return generation_;
+  }
+
+  friend constexpr bool operator==(const Slot_handle &,
+                                   const Slot_handle &) noexcept = default;
+
+  friend constexpr bool operator==(const Slot_handle &x,
+                                   std::nullptr_t) noexcept
+  {
+    return x.map_ == nullptr;
+  }
+
+private:
+  Slot_map<T> *map_ = nullptr;
+  std::uint32_t index_ = 0;
+  std::uint32_t generation_ = 0;
+};
+
+// Deleter for values owned by a Unique_slot: erases the value from its map
+template <typename T>
+struct Slot_delete {
+  using pointer = Slot_handle<T>;
+
+  void operator()(pointer handle) const noexcept
+  {
+    handle.map()->erase(handle);
+  }
+};
+
+// Move-only owner of a value in a Slot_map
+template <typename T>
+using Unique_slot = Unique_ptr<T, Slot_delete<T>>;
+
+namespace detail
+{
+
+template <typename Vector>
+struct Pop_back {
+  void operator()(Vector *v) const noexcept
+  {
+    v->pop_back();
+  }
+};
+
+} // namespace detail
+
+// Values in dense contiguous storage, addressed through generational slots.
+// Erasing moves the last value into the gap, so iteration always covers a
+// packed array in unspecified order. Slots of erased values are reused with
+// the next generation, stale handles see the mismatch.
+//
+// The map must outlive its Unique_slots and must not move while they exist.
+template <typename T>
+class Slot_map
+{
+public:
+  Slot_map() = default;
+
+  Slot_map(const Slot_map &) = delete;
+  Slot_map &operator=(const Slot_map &) = delete;
+
+  // Effects: Constructs a T from args at the end of the dense storage.
+  // Returns: The owner of the new value.
+  template <typename... Args>
+  Unique_slot<T> emplace(Args &&...args)
+  {
+    if (free_ == none) {
+      // free_ stays none if push_back throws
+      slots_.push_back({none, 0});
+      free_ = static_cast<std::uint32_t>(slots_.size() - 1);
+    }
+    slot_of_.push_back(free_);
+    Unique_ptr<std::vector<std::uint32_t>,
+               detail::Pop_back<std::vector<std::uint32_t>>>
+        undo(&slot_of_);
+    values_.emplace_back(std::forward<Args>(args)...);
+    static_cast<void>(undo.release());
+
+    const std::uint32_t index = free_;
+    Slot &slot = slots_[index];
+    free_ = slot.index;
+    slot.index = static_cast<std::uint32_t>(values_.size() - 1);
+    return Unique_slot<T>(Slot_handle<T>(this, index, slot.generation));
+  }
+
+  // Returns: The value handle refers to, or nullptr if it was erased.
+  T *find(Slot_handle<T> handle) noexcept
+  {
+    const Slot &slot = slots_[handle.index()];
+    return slot.generation == handle.generation() ? &values_[slot.index]
+                                                  : nullptr;
+  }
+
+  std::size_t size() const noexcept
+  {
+    return values_.size();
+  }
+
+  bool empty() const noexcept
+  {
+    return values_.empty();
+  }
+
+  // Returns: All values, packed.
+  std::span<T> values() noexcept
+  {
+    return values_;
+  }
+
+  std::span<const T> values() const noexcept
+  {
+    return values_;
+  }
+
+  auto begin() noexcept
+  {
+    return values_.begin();
+  }
+
+  auto end() noexcept
+  {
+    return values_.end();
+  }
+
+private:
+  friend struct Slot_delete<T>;
+
+  static constexpr std::uint32_t none = ~std::uint32_t{0};
+
+  // While the slot is in use, index is the value's position in values_,
+  // otherwise the next free slot
+  struct Slot {
+    std::uint32_t index;
+    std::uint32_t generation;
+  };
+
+  // Preconditions: handle refers to a value in this map.
+  void erase(Slot_handle<T> handle) noexcept
+  {
+    Slot &slot = slots_[handle.index()];
+    const std::uint32_t hole = slot.index;
+    if (hole != values_.size() - 1) {
+      values_[hole] = std::move(values_.back());
+      slot_of_[hole] = slot_of_.back();
+      slots_[slot_of_[hole]].index = hole;
+    }
+    values_.pop_back();
+    slot_of_.pop_back();
+
+    ++slot.generation;
+    slot.index = free_;
+    free_ = handle.index();
+  }
+
+  std::vector<T> values_;
+  // Slot of each value in values_
+  std::vector<std::uint32_t> slot_of_;
+  std::vector<Slot> slots_;
+  std::uint32_t free_ = none;
+};
@@ -0,0 +1,358 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "lru_list.h"
+#include "unique_buffer.h"
+#include "unique_ptr.h"
+
+// How a Spillable_ptr<T> writes its value to the spill file and reads it
+// back. The default copies the bytes of trivially copyable types, specialize
+// it for others.
+template <typename T>
+struct Spill_traits {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "specialize Spill_traits for types that are not trivially "
+                "copyable");
+
+  static bool save(const T &value, Unique_buffer &out) noexcept
+  {
+    out.clear();
+    return out.append(&value, sizeof(T));
+  }
+
+  static Unique_ptr<T> load(std::span<const std::byte> data) noexcept
+  {
+    if (data.size() != sizeof(T)) {
+      return nullptr;
+    }
+    Unique_ptr<T> value = make_unique_for_overwrite_nothrow<T>();
+    if (value != nullptr) {
+      std::memcpy(static_cast<void *>(value.get()), data.data(), sizeof(T));
+    }
+    return value;
+  }
+};
+
+// When a Spill_store writes values out: beyond max_resident_bytes the least
+// recently used go, and spill_idle() writes out everything not accessed for
+// max_idle.
+struct Spill_policy {
+  std::size_t max_resident_bytes = std::numeric_limits<std::size_t>::max();
+  std::chrono::steady_clock::duration max_idle =
+      std::chrono::steady_clock::duration::max();
+};
+
+namespace detail
+{
+
+// Place of a value in the spill file
+struct Spill_region {
+  std::uint64_t offset = 0;
+  std::uint64_t capacity = 0;
+  std::uint64_t size = 0;
+};
+
+// What the store knows of a Spillable_ptr
+struct Spill_entry : Lru_hook {
+  bool (*spill_out)(Spill_entry *) noexcept;
+  std::size_t bytes;
+  std::chrono::steady_clock::time_point last_access;
+};
+
+} // namespace detail
+
+// A spill file and the resident Spillable_ptrs in recency order. The file is
+// unlinked as soon as it is opened, so it goes away with the store. Not
+// thread-safe, like Discardable_registry.
+class Spill_store
+{
+public:
+  using clock = std::chrono::steady_clock;
+
+  // Effects: Creates the spill file at path, check operator bool for
+  // success.
+  Spill_store(const char *path, Spill_policy policy = {}) noexcept
+      : policy_(policy)
+  {
+    fd_ = ::open(path, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd_ != -1) {
+      ::unlink(path);
+    }
+  }
+
+  Spill_store(const Spill_store &) = delete;
+  Spill_store &operator=(const Spill_store &) = delete;
+
+  ~Spill_store()
+  {
+    if (fd_ != -1) {
+      ::close(fd_);
+    }
+  }
+
+  explicit operator bool() const noexcept
+  {
+    return fd_ != -1;
+  }
+
+  std::size_t resident_bytes() const noexcept
+  {
+    return resident_;
+  }
+
+  // Returns: The size of the spill file.
+  std::uint64_t file_bytes() const noexcept
+  {
+    return end_;
+  }
+
+  // Effects: Spills values, least recently used first, until at least bytes
+  // were written out or nothing is left.
+  // Returns: The bytes spilled.
+  std::size_t spill(std::size_t bytes) noexcept
+  {
+    std::size_t spilled = 0;
+    while (spilled < bytes && !list_.empty()) {
+      auto *entry = static_cast<detail::Spill_entry *>(list_.back());
+      if (!spill_entry(entry)) {
+        break;
+      }
+      spilled += entry->bytes;
+    }
+    return spilled;
+  }
+
+  // Effects: Spills every value not accessed for policy.max_idle.
+  // Returns: The bytes spilled.
+  std::size_t spill_idle(clock::time_point now = clock::now()) noexcept
+  {
+    std::size_t spilled = 0;
+    while (!list_.empty()) {
+      auto *entry = static_cast<detail::Spill_entry *>(list_.back());
+      if (now - entry->last_access < policy_.max_idle ||
+          !spill_entry(entry)) {
+        break;
+      }
+      spilled += entry->bytes;
+    }
+    return spilled;
+  }
+
+private:
+  template <typename T>
+  friend class Spillable_ptr;
+
+  // Writes the entry's value out, which calls back into release()
+  bool spill_entry(detail::Spill_entry *entry) noexcept
+  {
+    return entry->spill_out(entry);
+  }
+
+  void add(detail::Spill_entry *entry) noexcept
+  {
+    list_.push_front(entry);
+    resident_ += entry->bytes;
+  }
+
+  void release(detail::Spill_entry *entry) noexcept
+  {
+    list_.remove(entry);
+    resident_ -= entry->bytes;
+  }
+
+  // Effects: Spills the coldest values other than keep while over the cap.
+  void enforce_cap(detail::Spill_entry *keep) noexcept
+  {
+    while (resident_ > policy_.max_resident_bytes && list_.back() != keep) {
+      if (!spill_entry(static_cast<detail::Spill_entry *>(list_.back()))) {
+        break;
+      }
+    }
+  }
+
+  bool write(detail::Spill_region &region, Unique_buffer &data) noexcept
+  {
+    if (data.size() > region.capacity) {
+      detail::Spill_region grown;
+      if (!allocate(data.size(), grown)) {
+        return false;
+      }
+      free_region(region);
+      region = grown;
+    }
+    region.size = data.size();
+    return ::pwrite(fd_, data.data(), data.size(),
+                    static_cast<off_t>(region.offset)) ==
+           static_cast<ssize_t>(data.size());
+  }
+
+  bool read(const detail::Spill_region &region, Unique_buffer &out) noexcept
+  {
+    return out.resize(region.size) &&
+           ::pread(fd_, out.data(), region.size,
+                   static_cast<off_t>(region.offset)) ==
+               static_cast<ssize_t>(region.size);
+  }
+
+  // First fit in the regions of destroyed or grown values, else at the end.
+  // A region at the end also reserves its slot in free_, so free_region()
+  // never allocates. Returns false if that reservation fails.
+  bool allocate(std::uint64_t size, detail::Spill_region &region) noexcept
+  {
+    auto *regions = reinterpret_cast<detail::Spill_region *>(free_.data());
+    const std::size_t count = free_.size() / sizeof(detail::Spill_region);
+    for (std::size_t i = 0; i < count; ++i) {
+      if (regions[i].capacity >= size) {
+        region = regions[i];
+        regions[i] = regions[count - 1];
+        // Shrinking doesn't allocate
+        static_cast<void>(
+            free_.resize(free_.size() - sizeof(detail::Spill_region)));
+        return true;
+      }
+    }
+    const std::size_t needed = (regions_ + 1) * sizeof(detail::Spill_region);
+    if (needed > free_.capacity() && !free_.reserve(2 * needed)) {
+      return false;
+    }
+    ++regions_;
+    region = {end_, size, 0};
+    end_ += size;
+    return true;
+  }
+
+  void free_region(const detail::Spill_region &region) noexcept
+  {
+    if (region.capacity != 0) {
+      // Fits, allocate() reserved room for every region
+      static_cast<void>(free_.append(&region, sizeof(region)));
+    }
+  }
+
+  int fd_ = -1;
+  Spill_policy policy_;
+  Lru_list list_;
+  std::size_t resident_ = 0;
+  std::uint64_t end_ = 0;
+  // Regions allocated at the end of the file, each in use or in free_
+  std::size_t regions_ = 0;
+  // The free Spill_regions
+  Unique_buffer free_;
+  Unique_buffer scratch_;
+};
+
+// Owns a value that is written to its Spill_store's file and freed when it
+// gets cold, and read back on the next access. get() and the dereference
+// operators return nullptr, or fail, if the value can't be read back.
+template <typename T>
+class Spillable_ptr : private detail::Spill_entry
+{
+public:
+  // bytes is what the value pins, for the store's accounting
+  Spillable_ptr(Spill_store &store, Unique_ptr<T> value,
+                std::size_t bytes = sizeof(T)) noexcept
+      : Spill_entry{{}, &spill_value, bytes, Spill_store::clock::now()},
+        value_(std::move(value)),
+        store_(&store)
+  {
+    if (value_ != nullptr) {
+      store_->add(this);
+      store_->enforce_cap(this);
+    }
+  }
+
+  Spillable_ptr(Spillable_ptr &&other) noexcept
+      : Spill_entry{{}, &spill_value, other.bytes, other.last_access},
+        value_(std::move(other.value_)),
+        region_(std::exchange(other.region_, {})),
+        store_(other.store_)
+  {
+    if (store_->list_.contains(&other)) {
+      store_->list_.replace(&other, this);
+    }
+  }
+
+  Spillable_ptr &operator=(Spillable_ptr &&) = delete;
+
+  ~Spillable_ptr()
+  {
+    if (value_ != nullptr) {
+      store_->release(this);
+    }
+    store_->free_region(region_);
+  }
+
+  // Effects: Reads the value back if it was spilled, marks it as the most
+  // recently used and spills colder values if that exceeds the cap.
+  // Returns: The value, or nullptr if it could not be read back.
+  T *get() noexcept
+  {
+    if (value_ != nullptr) {
+      store_->list_.touch(this);
+    } else {
+      if (region_.size == 0 || !store_->read(region_, store_->scratch_)) {
+        return nullptr;
+      }
+      value_ = Spill_traits<T>::load(
+          std::span<const std::byte>(store_->scratch_.span()));
+      if (value_ == nullptr) {
+        return nullptr;
+      }
+      store_->add(this);
+    }
+    last_access = Spill_store::clock::now();
+    store_->enforce_cap(this);
+    return value_.get();
+  }
+
+  T &operator*() noexcept
+  {
+    return *get();
+  }
+
+  T *operator->() noexcept
+  {
+    return get();
+  }
+
+  bool resident() const noexcept
+  {
+    return value_ != nullptr;
+  }
+
+  // Effects: Writes the value out and frees it now.
+  // Returns: false if writing failed, the value stays resident then.
+  bool spill() noexcept
+  {
+    return value_ == nullptr || spill_value(this);
+  }
+
+private:
+  static bool spill_value(detail::Spill_entry *entry) noexcept
+  {
+    auto *self = static_cast<Spillable_ptr *>(entry);
+    Spill_store &store = *self->store_;
+    if (!Spill_traits<T>::save(*self->value_, store.scratch_) ||
+        !store.write(self->region_, store.scratch_)) {
+      return false;
+    }
+    store.release(self);
+    self->value_.reset();
+    return true;
+  }
+
+  Unique_ptr<T> value_;
+  detail::Spill_region region_;
+  Spill_store *store_;
+};
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <utility>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "unique_ptr.h"
+
+// Deleter for Unique_buffer storage: memory from the malloc family, or an
+// anonymous mapping of mapped() bytes if that is not zero.
+class Buffer_delete
+{
+public:
+  constexpr Buffer_delete() noexcept = default;
+
+  constexpr explicit Buffer_delete(std::size_t mapped) noexcept
+      : mapped_(mapped)
+  {
+  }
+
+  // Returns: The size of the mapping, or 0 if the memory is from malloc.
+  constexpr std::size_t mapped() const noexcept
+  {
+    return mapped_;
+  }
+
+  void operator()(std::byte *ptr) const noexcept
+  {
+#if defined(__linux__)
+    if (mapped_ != 0) {
+      ::munmap(ptr, mapped_);
+      return;
+    }
+#endif
+    std::free(ptr);
+  }
+
+private:
+  std::size_t mapped_ = 0;
+};
+
+// Growable owned byte buffer. Small buffers grow with realloc, which can often
+// extend in place. From mmap_threshold on the storage is an anonymous mapping
+// that grows with mremap, which moves pages instead of copying bytes (Linux
+// only, elsewhere realloc is used throughout).
+//
+// Growing reports allocation failure by returning false, the buffer is left
+// unchanged in that case.
+class Unique_buffer
+{
+public:
+  static constexpr std::size_t mmap_threshold = std::size_t{1} << 20;
+
+  Unique_buffer() noexcept = default;
+
+  Unique_buffer(Unique_buffer &&other) noexcept
+      : data_(std::exchange(other.data_, {})),
+        size_(std::exchange(other.size_, 0)),
+        capacity_(std::exchange(other.capacity_, 0))
+  {
+  }
+
+  Unique_buffer &operator=(Unique_buffer &&other) noexcept
+  {
+    // The exchange also resets other's deleter to malloc storage
+    data_ = std::exchange(other.data_, {});
+    size_ = std::exchange(other.size_, 0);
+    capacity_ = std::exchange(other.capacity_, 0);
+    return *this;
+  }
+
+  std::byte *data() const noexcept
+  {
+    return data_.get();
+  }
+
+  std::size_t size() const noexcept
+  {
+    return size_;
+  }
+
+  std::size_t capacity() const noexcept
+  {
+    return capacity_;
+  }
+
+  bool empty() const noexcept
+  {
+    return size_ == 0;
+  }
+
+  std::span<std::byte> span() const noexcept
+  {
+    return {data_.get(), size_};
+  }
+
+  // Effects: Makes room for at least n bytes without changing size().
+  // Returns: false if the allocation failed.
+  bool reserve(std::size_t n) noexcept
+  {
+    return n <= capacity_ || grow_to(n);
+  }
+
+  // Effects: Sets size() to n. Added bytes are uninitialized.
+  // Returns: false if the allocation failed.
+  bool resize(std::size_t n) noexcept
+  {
+    if (n > capacity_ && !grow(n)) {
+      return false;
+    }
+    size_ = n;
+    return true;
+  }
+
+  // Effects: Appends n bytes copied from src.
+  // Returns: false if the allocation failed.
+  bool append(const void *src, std::size_t n) noexcept
+  {
+    if (n > std::numeric_limits<std::size_t>::max() - size_) {
+      return false;
+    }
+    if (size_ + n > capacity_ && !grow(size_ + n)) {
+      return false;
+    }
+    std::memcpy(data_.get() + size_, src, n);
+    size_ += n;
+    return true;
+  }
+
+  void clear() noexcept
+  {
+    size_ = 0;
+  }
+
+  // Postconditions: size() == 0 and capacity() == 0.
+  // Returns: The storage, for handing it to code that frees it itself.
+  Unique_ptr<std::byte, Buffer_delete> release() noexcept
+  {
+    size_ = 0;
+    capacity_ = 0;
+    return std::exchange(data_, {});
+  }
+
+private:
+  // Geometric growth, so appending is amortized constant time
+  bool grow(std::size_t n) noexcept
+  {
+    if (capacity_ > std::numeric_limits<std::size_t>::max() / 2) {
+      return grow_to(n);
+    }
+    return grow_to(n > 2 * capacity_ ? n : 2 * capacity_);
+  }
+
+  bool grow_to(std::size_t n) noexcept
+  {
+#if defined(__linux__)
+    if (n >= mmap_threshold) {
+      return grow_mapped(n);
+    }
+#endif
+    void *ptr = std::realloc(data_.get(), n);
+    if (ptr == nullptr) {
+      return false;
+    }
+    // realloc freed or reused the old block, the new one is malloc storage
+    static_cast<void>(data_.release());
+    data_ = Unique_ptr<std::byte, Buffer_delete>(static_cast<std::byte *>(ptr),
+                                                 Buffer_delete());
+    capacity_ = n;
+    return true;
+  }
+
+#if defined(__linux__)
+  bool grow_mapped(std::size_t n) noexcept
+  {
+    const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    n = (n + page - 1) / page * page;
+
+    const std::size_t mapped = data_.get_deleter().mapped();
+    void *ptr;
+    if (mapped != 0) {
+      ptr = ::mremap(data_.get(), mapped, n, MREMAP_MAYMOVE);
+      if (ptr == MAP_FAILED) {
+        return false;
+      }
+      // mremap moved or extended the old mapping
+      static_cast<void>(data_.release());
+    } else {
+      ptr = ::mmap(nullptr, n, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (ptr == MAP_FAILED) {
+        return false;
+      }
+      if (size_ != 0) {
+        std::memcpy(ptr, data_.get(), size_);
+      }
+    }
+    // Frees the old malloc block, if any
+    data_ = Unique_ptr<std::byte, Buffer_delete>(static_cast<std::byte *>(ptr),
+                                                 Buffer_delete(n));
+    capacity_ = n;
+    return true;
+  }
+#endif
+
+  Unique_ptr<std::byte, Buffer_delete> data_;
+  std::size_t size_ = 0;
+  std::size_t capacity_ = 0;
+};
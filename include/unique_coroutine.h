@@ -0,0 +1,144 @@
+#pragma once
+
+#include <array>
+#include <coroutine>
+#include <cstddef>
+#include <new>
+
+#include "unique_ptr.h"
+
+// Deleter for coroutine frames. The stored pointer is the coroutine_handle
+// itself, so Unique_coroutine<Promise> is the size of a handle.
+template <typename Promise>
+struct Coroutine_delete {
+  using pointer = std::coroutine_handle<Promise>;
+
+  void operator()(pointer handle) const noexcept
+  {
+    handle.destroy();
+  }
+};
+
+// Owns a suspended coroutine, get() returns its handle. Promise types use it
+// as the return object of get_return_object().
+template <typename Promise>
+using Unique_coroutine = Unique_ptr<Promise, Coroutine_delete<Promise>>;
+
+// Returns: The owner of the coroutine whose promise is promise.
+template <typename Promise>
+Unique_coroutine<Promise> adopt_coroutine(Promise &promise) noexcept
+{
+  return Unique_coroutine<Promise>(
+      std::coroutine_handle<Promise>::from_promise(promise));
+}
+
+// Per-thread cache of coroutine frames in 64 byte size classes up to 1 KiB.
+// Freed frames are kept on an intrusive list per class, up to a limit, and
+// handed out again without going through operator new. Larger frames are
+// allocated directly.
+//
+// A frame may be freed on another thread than it was allocated on, it goes
+// to that thread's pool then. Frames must not be freed after their thread's
+// pool was destroyed at thread exit.
+class Frame_pool
+{
+public:
+  static constexpr std::size_t granularity = 64;
+  static constexpr std::size_t class_count = 16;
+  static constexpr std::size_t max_size = granularity * class_count;
+
+  explicit Frame_pool(std::size_t max_cached = 256) noexcept
+      : max_cached_(max_cached)
+  {
+  }
+
+  ~Frame_pool()
+  {
+    for (std::size_t cls = 0; cls < class_count; ++cls) {
+      while (Free_frame *frame = free_[cls]) {
+        free_[cls] = frame->next;
+        ::operator delete(frame, class_size(cls));
+      }
+    }
+  }
+
+  Frame_pool(const Frame_pool &) = delete;
+  Frame_pool &operator=(const Frame_pool &) = delete;
+
+  // Returns: The pool of the calling thread.
+  static Frame_pool &this_thread() noexcept
+  {
+    thread_local Frame_pool pool;
+    return pool;
+  }
+
+  // Returns: A block of at least size bytes. Throws bad_alloc like operator
+  // new if there is none cached and allocating fails.
+  void *allocate(std::size_t size)
+  {
+    if (size > max_size) {
+      return ::operator new(size);
+    }
+    const std::size_t cls = size_class(size);
+    if (Free_frame *frame = free_[cls]) {
+      free_[cls] = frame->next;
+      --count_[cls];
+      return frame;
+    }
+    return ::operator new(class_size(cls));
+  }
+
+  // Preconditions: ptr was returned by allocate(size) of any Frame_pool.
+  void deallocate(void *ptr, std::size_t size) noexcept
+  {
+    if (size > max_size) {
+      ::operator delete(ptr, size);
+      return;
+    }
+    const std::size_t cls = size_class(size);
+    if (count_[cls] == max_cached_) {
+      ::operator delete(ptr, class_size(cls));
+      return;
+    }
+    free_[cls] = ::new (ptr) Free_frame{free_[cls]};
+    ++count_[cls];
+  }
+
+  // Returns: The number of cached frames in size's class.
+  std::size_t cached(std::size_t size) const noexcept
+  {
+    return count_[size_class(size)];
+  }
+
+  static constexpr std::size_t class_size(std::size_t cls) noexcept
+  {
+    return (cls + 1) * granularity;
+  }
+
+  static constexpr std::size_t size_class(std::size_t size) noexcept
+  {
+    return size == 0 ? 0 : (size - 1) / granularity;
+  }
+
+private:
+  struct Free_frame {
+    Free_frame *next;
+  };
+
+  std::array<Free_frame *, class_count> free_{};
+  std::array<std::size_t, class_count> count_{};
+  std::size_t max_cached_;
+};
+
+// Base for promise types whose frames come from Frame_pool::this_thread().
+struct Pooled_frame {
+  static void *operator new(std::size_t size)
+  {
+    return Frame_pool::this_thread().allocate(size);
+  }
+
+  static void operator delete(void *ptr, std::size_t size) noexcept
+  {
+    Frame_pool::this_thread().deallocate(ptr, size);
+  }
+};
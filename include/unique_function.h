@@ -0,0 +1,215 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "unique_ptr.h"
+
+// Whether moving a T and destroying the source can be done by copying its
+// bytes. Specialize it for types that own through a pointer.
+template <typename T>
+struct Is_trivially_relocatable : std::is_trivially_copyable<T> {
+};
+
+template <typename T, typename D>
+struct Is_trivially_relocatable<Unique_ptr<T, D>>
+    : std::bool_constant<
+          Is_trivially_relocatable<typename Unique_ptr<T, D>::pointer>::value &&
+          Is_trivially_relocatable<D>::value> {
+};
+
+namespace detail
+{
+
+enum class Function_op { relocate, destroy };
+
+// Small trivially copyable arguments are passed by value to the invoker
+template <typename T>
+using Function_param =
+    std::conditional_t<std::is_trivially_copyable_v<T> &&
+                           sizeof(T) <= 2 * sizeof(void *),
+                       T, T &&>;
+
+// std::invoke_r is C++23
+template <typename R, typename F, typename... Args>
+constexpr R invoke_r(F &&f, Args &&...args)
+{
+  if constexpr (std::is_void_v<R>) {
+    std::invoke(std::forward<F>(f), std::forward<Args>(args)...);
+  } else {
+    return std::invoke(std::forward<F>(f), std::forward<Args>(args)...);
+  }
+}
+
+} // namespace detail
+
+template <typename Sig, std::size_t Capacity = 3 * sizeof(void *)>
+class Unique_function;
+
+// A move-only std::function. Callables up to Capacity bytes are stored in
+// place, larger ones in a Unique_ptr owned heap box. A call is one indirect
+// call. Moving is a copy of the buffer for trivially relocatable callables,
+// and the heap box is one.
+template <typename R, typename... Args, std::size_t Capacity>
+class Unique_function<R(Args...), Capacity>
+{
+  static_assert(Capacity >= sizeof(void *), "the heap box needs a pointer");
+
+public:
+  constexpr Unique_function() noexcept = default;
+
+  constexpr Unique_function(std::nullptr_t) noexcept {}
+
+  // Constraints: F is invocable with Args... and the result converts to R.
+  // Effects: Stores std::forward<F>(f) in place if it fits and can be moved
+  // without throwing, in a heap box otherwise. A null function pointer or
+  // member pointer leaves *this empty.
+  template <typename F, typename Fn = std::decay_t<F>>
+  Unique_function(F &&f) requires(
+      !std::is_same_v<Fn, Unique_function> &&
+      std::is_invocable_r_v<R, Fn &, Args...> &&
+      std::is_constructible_v<Fn, F>)
+  {
+    // Function references can't be null
+    if constexpr (std::is_pointer_v<std::remove_cvref_t<F>> ||
+                  std::is_member_pointer_v<std::remove_cvref_t<F>>) {
+      if (f == nullptr) {
+        return;
+      }
+    }
+    if constexpr (is_inline<Fn>) {
+      ::new (static_cast<void *>(storage_)) Fn(std::forward<F>(f));
+      invoke_ = &invoke_inline<Fn>;
+      if constexpr (!std::is_trivially_copyable_v<Fn>) {
+        manage_ = &manage_inline<Fn>;
+      }
+    } else {
+      ::new (static_cast<void *>(storage_))
+          Unique_ptr<Fn>(make_unique<Fn>(std::forward<F>(f)));
+      invoke_ = &invoke_boxed<Fn>;
+      manage_ = &manage_boxed<Fn>;
+    }
+  }
+
+  Unique_function(Unique_function &&other) noexcept
+  {
+    take(other);
+  }
+
+  Unique_function &operator=(Unique_function &&other) noexcept
+  {
+    if (this != &other) {
+      destroy();
+      take(other);
+    }
+    return *this;
+  }
+
+  Unique_function &operator=(std::nullptr_t) noexcept
+  {
+    destroy();
+    invoke_ = nullptr;
+    manage_ = nullptr;
+    return *this;
+  }
+
+  ~Unique_function()
+  {
+    destroy();
+  }
+
+  // Preconditions: *this is not empty.
+  R operator()(Args... args)
+  {
+    return invoke_(storage_, std::forward<Args>(args)...);
+  }
+
+  explicit operator bool() const noexcept
+  {
+    return invoke_ != nullptr;
+  }
+
+  friend bool operator==(const Unique_function &f, std::nullptr_t) noexcept
+  {
+    return !f;
+  }
+
+private:
+  using Invoke = R (*)(void *, detail::Function_param<Args>...);
+  using Manage = void (*)(detail::Function_op, void *, void *) noexcept;
+
+  template <typename Fn>
+  static constexpr bool is_inline =
+      sizeof(Fn) <= Capacity &&
+      alignof(Fn) <= alignof(std::max_align_t) &&
+      std::is_nothrow_move_constructible_v<Fn>;
+
+  template <typename Fn>
+  static R invoke_inline(void *storage, detail::Function_param<Args>... args)
+  {
+    return detail::invoke_r<R>(*std::launder(static_cast<Fn *>(storage)),
+                               std::forward<Args>(args)...);
+  }
+
+  template <typename Fn>
+  static R invoke_boxed(void *storage, detail::Function_param<Args>... args)
+  {
+    return detail::invoke_r<R>(
+        **std::launder(static_cast<Unique_ptr<Fn> *>(storage)),
+        std::forward<Args>(args)...);
+  }
+
+  template <typename Fn>
+  static void manage_inline(detail::Function_op op, void *dst,
+                            void *src) noexcept
+  {
+    Fn *from = std::launder(static_cast<Fn *>(src));
+    if (op == detail::Function_op::relocate) {
+      if constexpr (Is_trivially_relocatable<Fn>::value) {
+        std::memcpy(dst, src, sizeof(Fn));
+        return;
+      } else {
+        ::new (dst) Fn(std::move(*from));
+      }
+    }
+    from->~Fn();
+  }
+
+  // Unique_ptr<Fn> is trivially relocatable, only destruction does work
+  template <typename Fn>
+  static void manage_boxed(detail::Function_op op, void *dst,
+                           void *src) noexcept
+  {
+    if (op == detail::Function_op::relocate) {
+      std::memcpy(dst, src, sizeof(Unique_ptr<Fn>));
+    } else {
+      std::launder(static_cast<Unique_ptr<Fn> *>(src))->~Unique_ptr();
+    }
+  }
+
+  void take(Unique_function &other) noexcept
+  {
+    if (other.manage_ == nullptr) {
+      std::memcpy(storage_, other.storage_, Capacity);
+    } else {
+      other.manage_(detail::Function_op::relocate, storage_, other.storage_);
+    }
+    invoke_ = std::exchange(other.invoke_, nullptr);
+    manage_ = std::exchange(other.manage_, nullptr);
+  }
+
+  void destroy() noexcept
+  {
+    if (manage_ != nullptr) {
+      manage_(detail::Function_op::destroy, nullptr, storage_);
+    }
+  }
+
+  alignas(std::max_align_t) std::byte storage_[Capacity];
+  Invoke invoke_ = nullptr;
+  Manage manage_ = nullptr;
+};
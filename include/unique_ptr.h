@@ -1,13 +1,33 @@
 #pragma once
 
+// When built as part of the unique_ptr module (src/unique_ptr.cppm) the
+// standard headers are included in the global module fragment instead and the
+// declarations below are wrapped in an export block.
+#ifndef UNIQUE_PTR_BEGIN_EXPORT
+#include <compare>
+#include <new>
 #include <utility>
+#define UNIQUE_PTR_BEGIN_EXPORT
+#define UNIQUE_PTR_END_EXPORT
+#endif
 
 // Comments from https://eel.is/c++draft/unique.ptr
 
+UNIQUE_PTR_BEGIN_EXPORT
+
+// Included inside the export block so the module exports the declarations
+#include "unique_ptr_fwd.h"
+
 namespace detail
 {
 
-// Simplified equivalent of boost::compressed_pair for empty base optimization
+// Lets out_ptr() and inout_ptr() reach the stored pointer, see out_ptr.h
+struct Out_ptr_access;
+
+// Simplified equivalent of boost::compressed_pair for empty base optimization.
+// [[no_unique_address]] lets an empty D share storage with the pointer, which
+// saves instantiating a separate specialization deriving from D. Unlike the
+// base class approach this also works for final deleters.
 template <typename T, typename D>
 class Compressed_pair
 {
@@ -38,55 +58,21 @@ public:
     return second_;
   }
 
-  constexpr D &second() const noexcept
+  constexpr const D &second() const noexcept
   {
     return second_;
   }
 
 private:
   T first_{};
-  D second_{};
+  [[no_unique_address]] D second_{};
 };
 
-template <typename T, typename D>
-requires(std::is_empty_v<D> && !std::is_final_v<D>) class Compressed_pair<T, D>
-    : private D
-{
-public:
-  constexpr Compressed_pair() noexcept = default;
-
-  // Pass by value since T is a pointer
-  constexpr explicit Compressed_pair(T first) noexcept : first_(first) {}
-
-  template <typename U>
-  constexpr Compressed_pair(T first, U &&second) noexcept
-      : D(std::forward<U>(second)), first_(first)
-  {
-  }
-
-  constexpr T &first() noexcept
-  {
-    return first_;
-  }
-
-  constexpr const T &first() const noexcept
-  {
-    return first_;
-  }
-
-  constexpr D &second() noexcept
-  {
-    return *this;
-  }
-
-  constexpr D &second() const noexcept
-  {
-    return *this;
-  }
-
-private:
-  T first_{};
-};
+// Deleters for which assignment and swap have no effect, so Unique_ptr can
+// skip them
+template <typename D>
+inline constexpr bool is_stateless_v =
+    std::is_empty_v<D> && std::is_trivially_copyable_v<D>;
 
 template <typename T, typename D>
 struct Pointer {
@@ -130,8 +116,9 @@ struct Default_delete {
   }
 };
 
-// Unique_ptr for single objects
-template <typename T, typename D = Default_delete<T>>
+// Unique_ptr for single objects. The default template argument D =
+// Default_delete<T> is declared in unique_ptr_fwd.h.
+template <typename T, typename D>
 class Unique_ptr
 {
 public:
@@ -217,7 +204,7 @@ public:
       !std::is_array_v<U> &&
       ((std::is_reference_v<D> && std::is_same_v<E, D>) ||
        (!std::is_reference_v<D> && std::is_convertible_v<E, D>)))
-      : pair_(u.release(), std::forward<D>(u.get_deleter()))
+      : pair_(u.release(), std::forward<E>(u.get_deleter()))
   {
   }
 
@@ -229,8 +216,8 @@ public:
   // Effects: If get() == nullptr there are no effects. Otherwise get_deleter()(get()).
   constexpr ~Unique_ptr()
   {
-    if (get() != nullptr) {
-      get_deleter()(get());
+    if (pair_.first() != nullptr) {
+      pair_.second()(pair_.first());
     }
   }
 
@@ -247,7 +234,9 @@ public:
       requires std::is_move_assignable_v<D>
   {
     reset(u.release());
-    get_deleter() = std::forward<D>(u.get_deleter());
+    if constexpr (!detail::is_stateless_v<D>) {
+      pair_.second() = std::forward<D>(u.pair_.second());
+    }
     return *this;
   }
 
@@ -308,7 +297,7 @@ public:
     return pair_.second();
   }
 
-  constexpr deleter_type &get_deleter() const noexcept
+  constexpr const deleter_type &get_deleter() const noexcept
   {
     return pair_.second();
   }
@@ -340,7 +329,7 @@ public:
     pointer old_p = pair_.first();
     pair_.first() = p;
     if (old_p != nullptr) {
-      get_deleter()(old_p);
+      pair_.second()(old_p);
     }
   }
 
@@ -348,8 +337,13 @@ public:
   // Effects: Invokes swap on the stored pointers and on the stored deleters of *this and u.
   constexpr void swap(Unique_ptr &u) noexcept
   {
-    std::swap(pair_.first(), u.pair_.first());
-    std::swap(pair_.second(), u.pair_.second());
+    pointer p = pair_.first();
+    pair_.first() = u.pair_.first();
+    u.pair_.first() = p;
+    // Swapping deleters without state has no effect
+    if constexpr (!detail::is_stateless_v<D>) {
+      std::swap(pair_.second(), u.pair_.second());
+    }
   }
 
   // disable copy from lvalue
@@ -357,6 +351,8 @@ public:
   Unique_ptr &operator=(const Unique_ptr &) = delete;
 
 private:
+  friend struct detail::Out_ptr_access;
+
   detail::Compressed_pair<pointer, deleter_type> pair_{};
 };
 
@@ -382,6 +378,32 @@ make_unique_for_overwrite() requires(!std::is_array_v<T>)
   return Unique_ptr<T>(new T);
 }
 
+// Constraints: T is not an array type.
+// Returns: Unique_ptr<T>(new (std::nothrow) T(std::forward<Args>(args)...)), which owns nothing if the allocation fails.
+template <class T, class... Args>
+constexpr Unique_ptr<T>
+make_unique_nothrow(Args &&...args) requires(!std::is_array_v<T>)
+{
+  // Allocation does not fail during constant evaluation, where the nothrow
+  // form of operator new is not allowed
+  if (std::is_constant_evaluated()) {
+    return Unique_ptr<T>(new T(std::forward<Args>(args)...));
+  }
+  return Unique_ptr<T>(new (std::nothrow) T(std::forward<Args>(args)...));
+}
+
+// Constraints: T is not an array type.
+// Returns: Unique_ptr<T>(new (std::nothrow) T), which owns nothing if the allocation fails.
+template <class T>
+constexpr Unique_ptr<T>
+make_unique_for_overwrite_nothrow() requires(!std::is_array_v<T>)
+{
+  if (std::is_constant_evaluated()) {
+    return Unique_ptr<T>(new T);
+  }
+  return Unique_ptr<T>(new (std::nothrow) T);
+}
+
 //
 // Specialized algorithms
 //
@@ -432,3 +454,5 @@ requires std::three_way_comparable<
   return std::compare_three_way()(
       x.get(), static_cast<typename Unique_ptr<T, D>::pointer>(nullptr));
 }
+
+UNIQUE_PTR_END_EXPORT
@@ -0,0 +1,11 @@
+#pragma once
+
+// Forward declarations for headers that only need to name Unique_ptr, e.g. in
+// function declarations or through pointers and references. Include
+// unique_ptr.h where the type has to be complete.
+
+template <typename T>
+struct Default_delete;
+
+template <typename T, typename D = Default_delete<T>>
+class Unique_ptr;
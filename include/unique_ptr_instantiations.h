@@ -0,0 +1,22 @@
+#pragma once
+
+#include "unique_ptr.h"
+
+// Specializations that are explicitly instantiated in the
+// unique_ptr_instantiations library. Including this header declares them
+// extern, so translation units that use them link against the library instead
+// of instantiating them again.
+
+#ifndef UNIQUE_PTR_INSTANTIATE
+#define UNIQUE_PTR_INSTANTIATE extern template
+#endif
+
+UNIQUE_PTR_INSTANTIATE struct Default_delete<char>;
+UNIQUE_PTR_INSTANTIATE struct Default_delete<int>;
+UNIQUE_PTR_INSTANTIATE struct Default_delete<long>;
+UNIQUE_PTR_INSTANTIATE struct Default_delete<double>;
+
+UNIQUE_PTR_INSTANTIATE class Unique_ptr<char>;
+UNIQUE_PTR_INSTANTIATE class Unique_ptr<int>;
+UNIQUE_PTR_INSTANTIATE class Unique_ptr<long>;
+UNIQUE_PTR_INSTANTIATE class Unique_ptr<double>;
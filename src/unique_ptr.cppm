@@ -0,0 +1,11 @@
+module;
+
+#include <compare>
+#include <new>
+#include <utility>
+
+export module unique_ptr;
+
+#define UNIQUE_PTR_BEGIN_EXPORT export {
+#define UNIQUE_PTR_END_EXPORT }
+#include "unique_ptr.h"
@@ -0,0 +1,2 @@
+#define UNIQUE_PTR_INSTANTIATE template
+#include "unique_ptr_instantiations.h"
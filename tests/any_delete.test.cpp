@@ -0,0 +1,163 @@
+#include <catch2/catch.hpp>
+
+#include <cstddef>
+#include <new>
+#include <string>
+#include <type_traits>
+
+#include "any_delete.h"
+#include "delete_chain.h"
+
+namespace
+{
+
+int deleted = 0;
+
+struct Tracked {
+  ~Tracked()
+  {
+    ++deleted;
+  }
+};
+
+void free_int(int *p)
+{
+  ++deleted;
+  delete p;
+}
+
+// Counts its own heap allocations, Any_delete boxes it with a new-expression
+template <std::size_t Words>
+struct Padded_delete {
+  static inline int allocations = 0;
+
+  static void *operator new(std::size_t size)
+  {
+    ++allocations;
+    return ::operator new(size);
+  }
+
+  static void operator delete(void *p, std::size_t size) noexcept
+  {
+    ::operator delete(p, size);
+  }
+
+  void operator()(Tracked *p) const noexcept
+  {
+    delete p;
+  }
+
+  void *pad[Words]{};
+};
+
+struct Destroy {
+  template <typename T>
+  void operator()(T *p) const noexcept
+  {
+    delete p;
+  }
+};
+
+struct Count {
+  template <typename T>
+  void operator()(T *) const noexcept
+  {
+    ++deleted;
+  }
+};
+
+// A template call operator needs the pointer type spelled out
+struct Tracked_chain : Delete_chain<Count, Destroy> {
+  using pointer = Tracked *;
+};
+
+} // namespace
+
+TEST_CASE("Any deleter"
+          "[unique.ptr.any]")
+{
+  deleted = 0;
+
+  // Default_delete<Tracked> remembers the original type
+  Unique_ptr<void, Any_delete> up1 = make_unique<Tracked>();
+  REQUIRE(up1 != nullptr);
+  up1.reset();
+  REQUIRE(deleted == 1);
+
+  // Function pointer deleter
+  Unique_ptr<int, void (*)(int *)> up2(new int(2), &free_int);
+  up1 = std::move(up2);
+  REQUIRE(up2 == nullptr);
+  up1.reset();
+  REQUIRE(deleted == 2);
+
+  // Stateful deleter stored inline
+  int *count = &deleted;
+  auto counting = [count](Tracked *p) {
+    *count += 10;
+    delete p;
+  };
+  up1 = Unique_ptr<Tracked, decltype(counting)>(new Tracked, counting);
+  Unique_ptr<void, Any_delete> up3(std::move(up1));
+  up3.reset();
+  REQUIRE(deleted == 13);
+}
+
+TEST_CASE("Any deleter heap fallback"
+          "[unique.ptr.any]")
+{
+  deleted = 0;
+
+  // Larger than the inline storage and not trivially copyable
+  std::string tag = "a tag that does not fit into the small string buffer";
+  auto tagged = [tag, pad = std::size_t{0}](Tracked *p) {
+    REQUIRE(tag.size() > pad);
+    delete p;
+  };
+  static_assert(sizeof(tagged) > Any_delete::inline_size);
+
+  Unique_ptr<void, Any_delete> up1(new Tracked, Any_delete(tagged));
+  Unique_ptr<void, Any_delete> up2;
+  up2 = std::move(up1);
+  up2.reset();
+  REQUIRE(deleted == 1);
+}
+
+TEST_CASE("Any deleter inline storage"
+          "[unique.ptr.any]")
+{
+  deleted = 0;
+
+  // Up to inline_size bytes never allocate
+  static_assert(sizeof(Padded_delete<2>) == Any_delete::inline_size);
+  {
+    Unique_ptr<void, Any_delete> up1(new Tracked, Padded_delete<1>());
+    Unique_ptr<void, Any_delete> up2(new Tracked, Padded_delete<2>());
+    Unique_ptr<void, Any_delete> up3 = std::move(up2);
+  }
+  REQUIRE(Padded_delete<1>::allocations == 0);
+  REQUIRE(Padded_delete<2>::allocations == 0);
+  REQUIRE(deleted == 2);
+
+  {
+    Unique_ptr<void, Any_delete> up(new Tracked, Padded_delete<3>());
+  }
+  REQUIRE(Padded_delete<3>::allocations == 1);
+  REQUIRE(deleted == 3);
+}
+
+TEST_CASE("Any deleter constraints"
+          "[unique.ptr.any]")
+{
+  // Rejected, not a hard error
+  auto generic = [](auto *p) { delete p; };
+  static_assert(!std::is_constructible_v<Any_delete, int>);
+  static_assert(!std::is_constructible_v<Any_delete, decltype(generic)>);
+  static_assert(!std::is_constructible_v<Any_delete, Delete_chain<Destroy>>);
+
+  deleted = 0;
+  Unique_ptr<void, Any_delete> up =
+      Unique_ptr<Tracked, Tracked_chain>(new Tracked);
+  up.reset();
+  REQUIRE(deleted == 2);
+}
@@ -0,0 +1,18 @@
+# Compiles SOURCE to assembly with -O2 and fails if the output matches the
+# regular expression FORBID. Used by add_codegen_test() to check that
+# abstractions compile down to the expected code.
+
+execute_process(
+  COMMAND ${CXX} -std=c++20 -O2 -S -o - -I${INCLUDE} ${FLAGS} ${SOURCE}
+  OUTPUT_VARIABLE assembly
+  ERROR_VARIABLE errors
+  RESULT_VARIABLE result)
+
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "Compiling ${SOURCE} failed:\n${errors}")
+endif()
+
+string(REGEX MATCH "${FORBID}" match "${assembly}")
+if(match)
+  message(FATAL_ERROR "Found '${match}' in the assembly of ${SOURCE}:\n${assembly}")
+endif()
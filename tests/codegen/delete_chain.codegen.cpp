@@ -0,0 +1,37 @@
+#include "delete_chain.h"
+
+// Compiled to assembly by the delete_chain_codegen test, which fails if any
+// Delete_chain or Compressed_pair symbol is left, i.e. the chain did not
+// inline completely.
+
+struct S {
+  int value;
+};
+
+extern int destroyed;
+
+struct Stats {
+  void operator()(S *) const
+  {
+    ++destroyed;
+  }
+};
+
+struct Clear {
+  void operator()(S *p) const
+  {
+    p->value = 0;
+  }
+};
+
+using Chain = Delete_chain<Stats, Clear, Default_delete<S>>;
+
+extern "C" void destroy_chain(S *p)
+{
+  Unique_ptr<S, Chain> up(p);
+}
+
+extern "C" void reset_chain(Unique_ptr<S, Chain> *up, S *p)
+{
+  up->reset(p);
+}
@@ -0,0 +1,37 @@
+#include "out_ptr.h"
+
+// Compiled to assembly by the out_ptr_codegen test, which fails if any
+// Out_ptr or Inout_ptr symbol is left or the stack is used: the C API must
+// get the address of the stored pointer instead of a temporary that is
+// loaded and stored back afterwards.
+
+struct Foo;
+
+extern "C" int foo_create(Foo **out);
+extern "C" int foo_reopen(Foo **inout);
+extern "C" int foo_create_void(void **out);
+extern "C" void foo_destroy(Foo *foo);
+
+struct Foo_delete {
+  void operator()(Foo *p) const noexcept
+  {
+    foo_destroy(p);
+  }
+};
+
+using Foo_ptr = Unique_ptr<Foo, Foo_delete>;
+
+extern "C" int create(Foo_ptr &up)
+{
+  return foo_create(out_ptr(up));
+}
+
+extern "C" int reopen(Foo_ptr &up)
+{
+  return foo_reopen(inout_ptr(up));
+}
+
+extern "C" int create_void(Foo_ptr &up)
+{
+  return foo_create_void(out_ptr(up));
+}
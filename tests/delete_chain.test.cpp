@@ -0,0 +1,99 @@
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+#include "delete_chain.h"
+
+namespace
+{
+
+struct S {
+  int value = 0;
+};
+
+// Empty stages
+struct Stats {
+  static inline int count = 0;
+
+  void operator()(S *) const
+  {
+    ++count;
+  }
+};
+
+struct Check {
+  void operator()(S *p) const
+  {
+    REQUIRE(p != nullptr);
+  }
+};
+
+// Stateful stage
+struct Log {
+  std::vector<int> *log;
+
+  void operator()(S *p) const
+  {
+    log->push_back(p->value);
+  }
+};
+
+// Usable in constant expressions
+struct Counter {
+  int *count;
+
+  constexpr void operator()(int *) const
+  {
+    ++*count;
+  }
+};
+
+constexpr int chain_count()
+{
+  int count = 0;
+  {
+    Unique_ptr<int, Delete_chain<Counter, Default_delete<int>>> up(
+        new int(1), Delete_chain<Counter, Default_delete<int>>(
+                        Counter{&count}, Default_delete<int>()));
+    up.reset(new int(2));
+  }
+  return count;
+}
+
+} // namespace
+
+static_assert(sizeof(Delete_chain<Stats, Check, Default_delete<S>>) == 1);
+static_assert(sizeof(Unique_ptr<S, Delete_chain<Stats, Check,
+                                                Default_delete<S>>>) ==
+              sizeof(S *));
+static_assert(sizeof(Delete_chain<Stats, Log, Default_delete<S>>) ==
+              sizeof(Log));
+static_assert(chain_count() == 2);
+
+TEST_CASE("Delete chain"
+          "[unique.ptr.chain]")
+{
+  std::vector<int> log;
+  using Chain = Delete_chain<Stats, Log, Check, Default_delete<S>>;
+
+  Stats::count = 0;
+  {
+    Unique_ptr<S, Chain> up(new S{1}, Chain({}, Log{&log}, {}, {}));
+    REQUIRE(up.get_deleter().get<1>().log == &log);
+    up.reset(new S{2});
+    REQUIRE(Stats::count == 1);
+  }
+  REQUIRE(Stats::count == 2);
+  REQUIRE(log == std::vector<int>{1, 2});
+}
+
+TEST_CASE("Delete chain with repeated stages"
+          "[unique.ptr.chain]")
+{
+  using Chain = Delete_chain<Stats, Stats, Default_delete<S>>;
+  static_assert(std::is_empty_v<Chain>);
+
+  Stats::count = 0;
+  Unique_ptr<S, Chain>(new S{});
+  REQUIRE(Stats::count == 2);
+}
@@ -0,0 +1,133 @@
+#include <catch2/catch.hpp>
+
+#include <cstdio>
+#include <string>
+
+#include <unistd.h>
+
+#include "discardable_ptr.h"
+
+namespace
+{
+
+void write_file(const std::string &path, const char *contents)
+{
+  std::FILE *file = std::fopen(path.c_str(), "w");
+  std::fputs(contents, file);
+  std::fclose(file);
+}
+
+} // namespace
+
+TEST_CASE("LRU list"
+          "[lru.list]")
+{
+  Lru_hook a;
+  Lru_hook b;
+  Lru_hook c;
+  Lru_list list;
+  REQUIRE(list.empty());
+
+  list.push_front(&a);
+  list.push_front(&b);
+  list.push_front(&c);
+  REQUIRE(list.front() == &c);
+  REQUIRE(list.back() == &a);
+
+  list.touch(&a);
+  REQUIRE(list.front() == &a);
+  REQUIRE(list.back() == &b);
+
+  Lru_hook d;
+  list.replace(&c, &d);
+  REQUIRE(!list.contains(&c));
+  REQUIRE(list.contains(&d));
+  REQUIRE(a.next == &d);
+
+  list.remove(&a);
+  list.remove(&b);
+  REQUIRE(list.front() == &d);
+  REQUIRE(list.back() == &d);
+  list.remove(&d);
+  REQUIRE(list.empty());
+}
+
+TEST_CASE("Discardable pointer under memory pressure"
+          "[discardable.ptr]")
+{
+  const std::string psi = "discardable_psi_" + std::to_string(::getpid());
+  const std::string meminfo =
+      "discardable_meminfo_" + std::to_string(::getpid());
+  write_file(psi, "some avg10=0.00 avg60=0.00 avg300=0.00 total=0\n"
+                  "full avg10=0.00 avg60=0.00 avg300=0.00 total=0\n");
+  write_file(meminfo, "MemTotal:       16000000 kB\n"
+                      "MemFree:         8000000 kB\n"
+                      "MemAvailable:    8000000 kB\n");
+
+  Memory_pressure_config config;
+  config.psi_path = psi.c_str();
+  config.meminfo_path = meminfo.c_str();
+  config.discard_fraction = 0.5;
+  const Memory_pressure_monitor monitor(config);
+
+  Discardable_registry registry;
+  int built = 0;
+  auto make = [&](int value) {
+    return [&built, value] {
+      ++built;
+      return make_unique<int>(value);
+    };
+  };
+  Discardable_ptr a(registry, make(1), 100);
+  Discardable_ptr b(registry, make(2), 100);
+  Discardable_ptr c(registry, make(3), 100);
+  Discardable_ptr d(registry, make(4), 100);
+
+  // Values are built lazily
+  REQUIRE(!a.resident());
+  REQUIRE(*a == 1);
+  REQUIRE(*b == 2);
+  REQUIRE(*c == 3);
+  REQUIRE(*d == 4);
+  REQUIRE(built == 4);
+  REQUIRE(registry.resident_bytes() == 400);
+
+  REQUIRE(!monitor.under_pressure());
+  REQUIRE(monitor.poll(registry) == 0);
+
+  // Stalls on memory: the two coldest go
+  REQUIRE(*a == 1);
+  write_file(psi, "some avg10=42.00 avg60=10.00 avg300=2.00 total=123\n");
+  REQUIRE(monitor.under_pressure());
+  REQUIRE(monitor.poll(registry) == 200);
+  REQUIRE(a.resident());
+  REQUIRE(!b.resident());
+  REQUIRE(!c.resident());
+  REQUIRE(d.resident());
+
+  // Low available memory counts as well
+  write_file(psi, "some avg10=0.00 avg60=0.00 avg300=0.00 total=0\n");
+  write_file(meminfo, "MemTotal:       16000000 kB\n"
+                      "MemAvailable:     800000 kB\n");
+  REQUIRE(monitor.poll(registry) == 100);
+  REQUIRE(a.resident());
+  REQUIRE(!d.resident());
+
+  // Rebuilt on next access
+  REQUIRE(*b == 2);
+  REQUIRE(built == 5);
+  REQUIRE(registry.resident_bytes() == 200);
+
+  // Moving keeps the place in the recency order
+  Discardable_ptr moved = std::move(b);
+  REQUIRE(registry.discard(100) == 100);
+  REQUIRE(!a.resident());
+  REQUIRE(moved.resident());
+
+  c.discard();
+  moved.discard();
+  REQUIRE(registry.resident_bytes() == 0);
+
+  std::remove(psi.c_str());
+  std::remove(meminfo.c_str());
+}
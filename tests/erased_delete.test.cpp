@@ -0,0 +1,43 @@
+#include <catch2/catch.hpp>
+
+#include "erased_delete.h"
+
+namespace
+{
+
+int deleted = 0;
+
+struct Counting_delete {
+  void operator()(int *p) const
+  {
+    ++deleted;
+    delete p;
+  }
+};
+
+} // namespace
+
+TEST_CASE("Erased deleter"
+          "[unique.ptr.erased]")
+{
+  deleted = 0;
+
+  Unique_ptr<int, Erased_delete<int>> up1(new int(1));
+  REQUIRE(*up1 == 1);
+  REQUIRE(sizeof(up1) == 2 * sizeof(void *));
+
+  Unique_ptr<int, Counting_delete> up2(new int(2));
+  Unique_ptr<int, Erased_delete<int>> up3(std::move(up2));
+  REQUIRE(up2 == nullptr);
+  REQUIRE(*up3 == 2);
+
+  // Both deleters have the same type after erasure
+  up1 = std::move(up3);
+  REQUIRE(deleted == 0);
+  up1.reset();
+  REQUIRE(deleted == 1);
+
+  up1 = make_unique<int>(3);
+  up1.reset();
+  REQUIRE(deleted == 1);
+}
@@ -0,0 +1,106 @@
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <cstring>
+
+#include "flat_serialize.h"
+
+namespace
+{
+
+struct Node {
+  int key;
+  double value;
+  Unique_ptr<Node> left;
+  Unique_ptr<Node> right;
+};
+
+Unique_ptr<Node> make_node(int key, Unique_ptr<Node> left = nullptr,
+                           Unique_ptr<Node> right = nullptr)
+{
+  auto node = make_unique<Node>();
+  node->key = key;
+  node->value = key / 2.0;
+  node->left = std::move(left);
+  node->right = std::move(right);
+  return node;
+}
+
+int sum(const Node *node)
+{
+  return node == nullptr
+             ? 0
+             : node->key + sum(node->left.get()) + sum(node->right.get());
+}
+
+} // namespace
+
+template <>
+struct Flat_layout<Node> {
+  static constexpr std::array children{&Node::left, &Node::right};
+};
+
+TEST_CASE("Flat serialization"
+          "[flat.serialize]")
+{
+  auto tree = make_node(4, make_node(2, make_node(1), make_node(3)),
+                        make_node(6, nullptr, make_node(7)));
+
+  Unique_buffer buffer;
+  REQUIRE(flat_save(tree.get(), buffer));
+
+  // Relocatable: the copy has no link to the original buffer
+  Unique_buffer copy;
+  REQUIRE(copy.append(buffer.data(), buffer.size()));
+  buffer.clear();
+
+  Flat_view<Node> root = flat_view<Node>(copy.span());
+  REQUIRE(root);
+  REQUIRE(root->key == 4);
+  REQUIRE(root->value == 2.0);
+  REQUIRE(root->left == nullptr);
+  REQUIRE(root.child(0)->key == 2);
+  REQUIRE(root.child(&Node::left).child(&Node::right)->key == 3);
+  REQUIRE(!root.child(&Node::right).child(&Node::left));
+  REQUIRE(root.child(1).child(1)->key == 7);
+
+  Unique_flat_ptr<Node> loaded = flat_load<Node>(copy.span());
+  REQUIRE(loaded != nullptr);
+  REQUIRE(loaded.get_deleter().count() == 6);
+  REQUIRE(sum(loaded.get()) == sum(tree.get()));
+  REQUIRE(loaded->right->right->value == 3.5);
+  REQUIRE(loaded->right->left == nullptr);
+
+  // Not a tree of Node
+  REQUIRE(!flat_view<Node>(copy.span().first(8)));
+  REQUIRE(flat_load<Node>(copy.span().first(copy.size() - 1)) == nullptr);
+  copy.data()[0] = std::byte{0};
+  REQUIRE(!flat_view<Node>(copy.span()));
+
+  REQUIRE(flat_save<Node>(nullptr, buffer));
+  REQUIRE(!flat_view<Node>(buffer.span()));
+  REQUIRE(flat_load<Node>(buffer.span()) == nullptr);
+}
+
+TEST_CASE("Flat serialization rejects non-trees"
+          "[flat.serialize]")
+{
+  auto tree = make_node(1, make_node(2), make_node(3));
+  Unique_buffer buffer;
+  REQUIRE(flat_save(tree.get(), buffer));
+  REQUIRE(flat_load<Node>(buffer.span()) != nullptr);
+
+  // Records are root, left, right. Pointing the root's right link at the
+  // left child gives that child two parents and leaves one record orphaned.
+  using Format = detail::Flat_format<Node>;
+  std::byte *root = buffer.data() + Format::records;
+  const auto left = static_cast<std::int64_t>(Format::stride);
+  std::memcpy(root + Format::links + sizeof(left), &left, sizeof(left));
+  REQUIRE(flat_load<Node>(buffer.span()) == nullptr);
+
+  // A record without a parent
+  const std::int64_t none = 0;
+  std::memcpy(root + Format::links + sizeof(none), &none, sizeof(none));
+  REQUIRE(flat_load<Node>(buffer.span()) == nullptr);
+}
+
@@ -0,0 +1,70 @@
+#include <catch2/catch.hpp>
+
+#include <array>
+
+#include "frozen.h"
+
+namespace
+{
+
+struct Node {
+  int key = 0;
+  Unique_ptr<Node> left;
+  Unique_ptr<Node> right;
+};
+
+constexpr Unique_ptr<Node> build(int first, int last)
+{
+  if (first == last) {
+    return nullptr;
+  }
+  const int mid = first + (last - first) / 2;
+  auto node = make_unique<Node>();
+  node->key = mid;
+  node->left = build(first, mid);
+  node->right = build(mid + 1, last);
+  return node;
+}
+
+template <typename View>
+constexpr bool contains(View node, int key)
+{
+  while (node && node->key != key) {
+    node = node.child(key < node->key ? &Node::left : &Node::right);
+  }
+  return static_cast<bool>(node);
+}
+
+} // namespace
+
+template <>
+struct Flat_layout<Node> {
+  static constexpr std::array children{&Node::left, &Node::right};
+};
+
+namespace
+{
+
+constexpr auto tree = freeze([] { return build(0, 100); });
+constexpr auto empty = freeze([] { return Unique_ptr<Node>(); });
+
+} // namespace
+
+TEST_CASE("Frozen tree"
+          "[frozen]")
+{
+  static_assert(tree.size() == 100);
+  static_assert(tree.root()->key == 50);
+  static_assert(tree.root().child(&Node::left)->key == 25);
+  static_assert(tree.root().child(0).child(1)->key == 38);
+  static_assert(contains(tree.root(), 0) && contains(tree.root(), 99));
+  static_assert(!contains(tree.root(), 100));
+  static_assert(empty.size() == 0 && !empty.root());
+
+  // Child members are null, the links are in the views
+  REQUIRE(tree.root()->left == nullptr);
+  for (int key = 0; key < 100; ++key) {
+    REQUIRE(contains(tree.root(), key));
+  }
+  REQUIRE(!contains(tree.root(), -1));
+}
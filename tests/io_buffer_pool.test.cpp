@@ -0,0 +1,73 @@
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <thread>
+
+#include "io_buffer_pool.h"
+
+TEST_CASE("I/O buffer pool"
+          "[io.buffer.pool]")
+{
+  Io_buffer_pool pool(2);
+
+  Io_buffer buf1 = pool.acquire(100);
+  REQUIRE(buf1 != nullptr);
+  REQUIRE(buf1.get_deleter().size() == 4096);
+  REQUIRE(reinterpret_cast<std::uintptr_t>(buf1.get()) % 4096 == 0);
+
+  Io_buffer buf2 = pool.acquire(5000);
+  REQUIRE(buf2.get_deleter().size() == 16384);
+
+  // Released buffers are reused
+  std::byte *p1 = buf1.get();
+  buf1.reset();
+  REQUIRE(pool.cached(4096) == 1);
+  buf1 = pool.acquire(4096);
+  REQUIRE(buf1.get() == p1);
+  REQUIRE(pool.cached(4096) == 0);
+
+  // The cache is bounded
+  REQUIRE(pool.prefault(4096, 5) == 2);
+  buf1.reset();
+  REQUIRE(pool.cached(4096) == 2);
+
+  // Too large for the size classes
+  Io_buffer big = pool.acquire(Io_buffer_pool::max_size + 1);
+  REQUIRE(big.get_deleter().size() == Io_buffer_pool::max_size + 4096);
+  REQUIRE(reinterpret_cast<std::uintptr_t>(big.get()) % 4096 == 0);
+}
+
+TEST_CASE("I/O buffer pool release on another thread"
+          "[io.buffer.pool]")
+{
+  Io_buffer_pool pool;
+  Io_buffer buf = pool.acquire(1 << 20);
+  std::thread([b = std::move(buf)]() mutable { b.reset(); }).join();
+  REQUIRE(pool.cached(1 << 20) == 1);
+}
+
+TEST_CASE("Shared I/O buffer pool"
+          "[io.buffer.pool]")
+{
+  Io_buffer_pool &pool = Io_buffer_pool::shared();
+  REQUIRE(pool.cached(Io_buffer_pool::max_size + 1) == 0);
+  REQUIRE(pool.prefault(Io_buffer_pool::max_size + 1, 1) == 0);
+
+  // The per-thread cache hands a released buffer straight back
+  Io_buffer buf = pool.acquire(4096);
+  std::byte *p = buf.get();
+  buf.reset();
+  buf = pool.acquire(4096);
+  REQUIRE(buf.get() == p);
+
+  // Buffers may outlive the thread that acquired them, and the thread's
+  // cache goes back to the pool when it exits
+  const std::size_t before = pool.cached(16384);
+  Io_buffer outlived;
+  std::thread([&] {
+    outlived = pool.acquire(16384);
+    pool.acquire(16384).reset();
+  }).join();
+  REQUIRE(pool.cached(16384) == before + 1);
+  outlived.reset();
+}
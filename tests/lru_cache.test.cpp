@@ -0,0 +1,100 @@
+#include <catch2/catch.hpp>
+
+#include <string>
+
+#include "lru_cache.h"
+
+namespace
+{
+
+struct Counting_delete {
+  int *deleted;
+
+  void operator()(int *p) const
+  {
+    ++*deleted;
+    delete p;
+  }
+};
+
+// Every key collides, exercises probing and backward shift deletion
+struct Same_hash {
+  std::size_t operator()(int) const
+  {
+    return 1;
+  }
+};
+
+} // namespace
+
+TEST_CASE("LRU cache"
+          "[lru.cache]")
+{
+  Lru_cache<std::string, int> cache(3);
+  REQUIRE(cache.capacity() == 3);
+
+  REQUIRE(!cache.insert("a", make_unique<int>(1)));
+  REQUIRE(!cache.insert("b", make_unique<int>(2)));
+  REQUIRE(!cache.insert("c", make_unique<int>(3)));
+  REQUIRE(cache.size() == 3);
+
+  // A hit makes "a" the most recently used, so "b" goes first
+  REQUIRE(*cache.find("a") == 1);
+  auto evicted = cache.insert("d", make_unique<int>(4));
+  REQUIRE(evicted);
+  REQUIRE(evicted.key == "b");
+  REQUIRE(*evicted.value == 2);
+  REQUIRE(cache.find("b") == nullptr);
+
+  // peek does not touch recency
+  REQUIRE(*cache.peek("c") == 3);
+  evicted = cache.insert("e", make_unique<int>(5));
+  REQUIRE(evicted.key == "c");
+
+  // Replacing hands back the old value
+  evicted = cache.insert("a", make_unique<int>(10));
+  REQUIRE(evicted.key == "a");
+  REQUIRE(*evicted.value == 1);
+  REQUIRE(*cache.find("a") == 10);
+  REQUIRE(cache.size() == 3);
+
+  evicted = cache.erase("d");
+  REQUIRE(*evicted.value == 4);
+  REQUIRE(!cache.erase("d"));
+  REQUIRE(cache.size() == 2);
+}
+
+TEST_CASE("LRU cache deleter"
+          "[lru.cache]")
+{
+  int deleted = 0;
+  using Owner = Unique_ptr<int, Counting_delete>;
+  Lru_cache<int, int, Counting_delete, Same_hash> cache(4);
+
+  for (int i = 0; i < 4; ++i) {
+    cache.insert(i, Owner(new int(i), Counting_delete{&deleted}));
+  }
+  REQUIRE(deleted == 0);
+
+  // Dropping the evicted entry runs the deleter
+  cache.insert(4, Owner(new int(4), Counting_delete{&deleted}));
+  REQUIRE(deleted == 1);
+
+  // Keeping it defers the deleter
+  {
+    auto evicted =
+        cache.insert(5, Owner(new int(5), Counting_delete{&deleted}));
+    REQUIRE(evicted.key == 1);
+    REQUIRE(deleted == 1);
+  }
+  REQUIRE(deleted == 2);
+
+  // Everything is still found after removals from the middle of the probe
+  // sequence
+  cache.erase(3);
+  REQUIRE(deleted == 3);
+  REQUIRE(*cache.find(2) == 2);
+  REQUIRE(*cache.find(4) == 4);
+  REQUIRE(*cache.find(5) == 5);
+  REQUIRE(cache.find(3) == nullptr);
+}
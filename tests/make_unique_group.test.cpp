@@ -0,0 +1,99 @@
+#include <catch2/catch.hpp>
+
+#include "make_unique_group.h"
+
+namespace
+{
+
+int alive = 0;
+
+struct Payload {
+  Payload() noexcept
+  {
+    ++alive;
+  }
+
+  ~Payload()
+  {
+    --alive;
+  }
+
+  int value = 0;
+};
+
+struct Node {
+  Node() noexcept = default;
+
+  Node(Unique_group_ptr<Node> left, Unique_group_ptr<Node> right,
+       Unique_group_ptr<Payload> payload, int value)
+      : left(std::move(left)), right(std::move(right)),
+        payload(std::move(payload)), value(value)
+  {
+    if (value < 0) {
+      throw value;
+    }
+  }
+
+  Unique_group_ptr<Node> left;
+  Unique_group_ptr<Node> right;
+  Unique_group_ptr<Payload> payload;
+  int value = 0;
+};
+
+struct Throwing_arg {
+  Throwing_arg(int value)
+  {
+    throw value;
+  }
+};
+
+struct Holder {
+  Holder(Unique_group_ptr<Payload> payload, Throwing_arg)
+      : payload(std::move(payload))
+  {
+  }
+
+  Unique_group_ptr<Payload> payload;
+};
+
+} // namespace
+
+TEST_CASE("Group allocation"
+          "[unique.ptr.group]")
+{
+  alive = 0;
+
+  auto node = make_unique_group<Node, Node, Node, Payload>(7);
+  REQUIRE(node->value == 7);
+  REQUIRE(node->left != nullptr);
+  REQUIRE(node->right != nullptr);
+  REQUIRE(node->payload->value == 0);
+  REQUIRE(alive == 1);
+
+  // Contiguous: the children follow the parent
+  auto *base = reinterpret_cast<std::byte *>(node.get());
+  REQUIRE(reinterpret_cast<std::byte *>(node->left.get()) - base ==
+          sizeof(Node));
+  REQUIRE(reinterpret_cast<std::byte *>(node->right.get()) - base ==
+          2 * sizeof(Node));
+
+  // Members outlive the parent, the block stays until the last one is gone
+  Unique_group_ptr<Payload> payload = std::move(node->payload);
+  node.reset();
+  REQUIRE(alive == 1);
+  payload->value = 3;
+  payload.reset();
+  REQUIRE(alive == 0);
+}
+
+TEST_CASE("Group allocation exception safety"
+          "[unique.ptr.group]")
+{
+  alive = 0;
+  REQUIRE_THROWS(make_unique_group<Node, Node, Node, Payload>(-1));
+  REQUIRE(alive == 0);
+
+  // An argument conversion throws before the constructor runs
+  REQUIRE_THROWS(make_unique_group<Holder, Payload>(1));
+  REQUIRE(alive == 0);
+}
@@ -0,0 +1,106 @@
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <numeric>
+
+#include "make_unique_trailing.h"
+
+namespace
+{
+
+int alive = 0;
+
+struct Header {
+  explicit Header(int id) : id(id)
+  {
+    ++alive;
+  }
+
+  ~Header()
+  {
+    --alive;
+  }
+
+  int id;
+  char tag = 'h';
+};
+
+struct alignas(16) Elem {
+  Elem()
+  {
+    ++alive;
+  }
+
+  ~Elem()
+  {
+    --alive;
+  }
+
+  long value = 0;
+};
+
+struct Throwing {
+  Throwing()
+  {
+    throw 42;
+  }
+};
+
+} // namespace
+
+TEST_CASE("Trailing elements"
+          "[unique.ptr.trailing]")
+{
+  alive = 0;
+  {
+    auto up = make_unique_trailing<Header, Elem>(5, 7);
+    REQUIRE(alive == 6);
+    REQUIRE(up->id == 7);
+
+    std::span<Elem> elems = trailing(up);
+    REQUIRE(elems.size() == 5);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(elems.data()) % 16 == 0);
+    REQUIRE(reinterpret_cast<std::byte *>(elems.data()) -
+                reinterpret_cast<std::byte *>(up.get()) ==
+            16);
+    for (Elem &e : elems) {
+      REQUIRE(e.value == 0);
+      e.value = 3;
+    }
+    REQUIRE(std::accumulate(elems.begin(), elems.end(), 0L,
+                            [](long sum, const Elem &e) {
+                              return sum + e.value;
+                            }) == 15);
+
+    up.reset();
+    REQUIRE(alive == 0);
+  }
+
+  auto empty = make_unique_trailing_for_overwrite<Header, char>(0, 1);
+  REQUIRE(trailing(empty).empty());
+  REQUIRE(sizeof(empty) == 2 * sizeof(void *));
+}
+
+TEST_CASE("Trailing elements exception safety"
+          "[unique.ptr.trailing]")
+{
+  alive = 0;
+  REQUIRE_THROWS(make_unique_trailing<Throwing, Elem>(3));
+  REQUIRE(alive == 0);
+}
+
+TEST_CASE("Trailing elements count overflow"
+          "[unique.ptr.trailing]")
+{
+  const std::size_t over = Trailing_delete<Header, Elem>::max_count + 1;
+  const std::size_t max = std::numeric_limits<std::size_t>::max();
+  alive = 0;
+  REQUIRE_THROWS_AS((make_unique_trailing<Header, Elem>(over, 1)),
+                    std::bad_array_new_length);
+  REQUIRE_THROWS_AS((make_unique_trailing<Header, Elem>(max, 1)),
+                    std::bad_array_new_length);
+  REQUIRE((make_unique_trailing_nothrow<Header, Elem>(max, 1)) == nullptr);
+  REQUIRE(alive == 0);
+}
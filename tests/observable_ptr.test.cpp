@@ -0,0 +1,79 @@
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "observable_ptr.h"
+
+namespace
+{
+
+struct alignas(32) Widget {
+  explicit Widget(int value) : value(value) {}
+
+  int value;
+};
+
+} // namespace
+
+TEST_CASE("Observable pointer"
+          "[observable.ptr]")
+{
+  auto owner = make_unique_observable<Widget>(1);
+  REQUIRE(sizeof(owner) == sizeof(Widget *));
+  REQUIRE(reinterpret_cast<std::uintptr_t>(owner.get()) % 32 == 0);
+
+  Weak_observer<Widget> empty;
+  REQUIRE(empty.expired());
+  REQUIRE(!empty.lock());
+
+  Weak_observer observer(owner);
+  Weak_observer copy = observer;
+  REQUIRE(!observer.expired());
+  REQUIRE(observer.get()->value == 1);
+  if (auto locked = copy.lock()) {
+    REQUIRE(locked->value == 1);
+  } else {
+    FAIL();
+  }
+
+  // Moving the owner keeps the observers attached
+  Unique_observable_ptr<Widget> moved = std::move(owner);
+  REQUIRE(!observer.expired());
+  Weak_observer second(moved);
+  moved.reset();
+  REQUIRE(observer.expired());
+  REQUIRE(copy.get() == nullptr);
+  REQUIRE(!second.lock());
+
+  // Observers of an empty owner are expired
+  REQUIRE(Weak_observer<Widget>(moved).expired());
+}
+
+TEST_CASE("Observable pointer destroyed while locked"
+          "[observable.ptr]")
+{
+  auto owner = make_unique_observable<Widget>(2);
+  Weak_observer observer(owner);
+  std::atomic<bool> destroyed = false;
+
+  std::thread thread;
+  {
+    auto locked = observer.lock();
+    REQUIRE(locked);
+    thread = std::thread([&] {
+      owner.reset();
+      destroyed = true;
+    });
+    // The owner can't finish while the object is locked
+    while (!observer.expired()) {
+      std::this_thread::yield();
+    }
+    REQUIRE(!destroyed);
+    REQUIRE(locked->value == 2);
+    REQUIRE(!observer.lock());
+  }
+  thread.join();
+  REQUIRE(destroyed);
+}
@@ -0,0 +1,125 @@
+#include <catch2/catch.hpp>
+
+#include "out_ptr.h"
+
+namespace
+{
+
+struct Foo {
+  int value;
+};
+
+int freed = 0;
+
+// A C API that creates, replaces and frees Foos
+int foo_create(Foo **out, int value)
+{
+  *out = new Foo{value};
+  return 0;
+}
+
+int foo_create_void(void **out, int value)
+{
+  *out = new Foo{value};
+  return 0;
+}
+
+int foo_fail(Foo **)
+{
+  return -1;
+}
+
+int foo_grow(Foo **inout)
+{
+  const int value = (*inout)->value;
+  delete *inout;
+  ++freed;
+  *inout = new Foo{value + 1};
+  return 0;
+}
+
+struct Foo_delete {
+  void operator()(Foo *p) const noexcept
+  {
+    ++freed;
+    delete p;
+  }
+};
+
+// A deleter with state, so the adapter can't write directly
+struct Counting_delete {
+  int *count = nullptr;
+
+  void operator()(Foo *p) const noexcept
+  {
+    ++*count;
+    delete p;
+  }
+};
+
+} // namespace
+
+TEST_CASE("out_ptr"
+          "[out.ptr]")
+{
+  freed = 0;
+  Unique_ptr<Foo, Foo_delete> up;
+
+  REQUIRE(foo_create(out_ptr(up), 1) == 0);
+  REQUIRE(up->value == 1);
+
+  // The old object is freed first, a failing call leaves the owner empty
+  REQUIRE(foo_create(out_ptr(up), 2) == 0);
+  REQUIRE(freed == 1);
+  REQUIRE(up->value == 2);
+  REQUIRE(foo_fail(out_ptr(up)) == -1);
+  REQUIRE(freed == 2);
+  REQUIRE(up == nullptr);
+
+  REQUIRE(foo_create_void(out_ptr(up), 3) == 0);
+  REQUIRE(up->value == 3);
+
+  // Extra arguments go to the constructor
+  int count = 0;
+  Unique_ptr<Foo, Counting_delete> counted;
+  REQUIRE(foo_create(out_ptr(counted, Counting_delete{&count}), 4) == 0);
+  REQUIRE(counted->value == 4);
+  counted.reset();
+  REQUIRE(count == 1);
+
+  // The arguments are copied, the adapter may outlive them
+  {
+    auto out = out_ptr(counted, Counting_delete{&count});
+    REQUIRE(foo_create(out, 6) == 0);
+  }
+  REQUIRE(counted->value == 6);
+  counted.reset();
+  REQUIRE(count == 2);
+
+  // Through a temporary of another pointer type
+  REQUIRE(foo_create_void(out_ptr<void *>(up), 5) == 0);
+  REQUIRE(up->value == 5);
+}
+
+TEST_CASE("inout_ptr"
+          "[out.ptr]")
+{
+  freed = 0;
+  Unique_ptr<Foo, Foo_delete> up(new Foo{1});
+
+  REQUIRE(foo_grow(inout_ptr(up)) == 0);
+  REQUIRE(freed == 1);
+  REQUIRE(up->value == 2);
+
+  // Unchanged if the API doesn't write
+  Foo *before = up.get();
+  REQUIRE(foo_fail(inout_ptr(up)) == -1);
+  REQUIRE(up.get() == before);
+
+  int count = 0;
+  Unique_ptr<Foo, Counting_delete> counted(new Foo{1}, Counting_delete{&count});
+  REQUIRE(foo_grow(inout_ptr(counted, Counting_delete{&count})) == 0);
+  REQUIRE(counted->value == 2);
+  counted.reset();
+  REQUIRE(count == 1);
+}
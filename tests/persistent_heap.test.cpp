@@ -0,0 +1,184 @@
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "persistent_heap.h"
+
+namespace
+{
+
+struct Entry {
+  Entry(int k, Unique_persistent_ptr<Entry> n) : key(k), next(std::move(n)) {}
+
+  int key;
+  Unique_persistent_ptr<Entry> next;
+};
+
+std::string heap_path()
+{
+  return "persistent_heap_test_" + std::to_string(::getpid()) + ".heap";
+}
+
+std::string read_file(const std::string &path)
+{
+  std::string contents;
+  std::FILE *file = std::fopen(path.c_str(), "r");
+  char chunk[4096];
+  for (std::size_t n; (n = std::fread(chunk, 1, sizeof(chunk), file)) > 0;) {
+    contents.append(chunk, n);
+  }
+  std::fclose(file);
+  return contents;
+}
+
+} // namespace
+
+TEST_CASE("Persistent heap"
+          "[persistent.heap]")
+{
+  const std::string path = heap_path();
+  std::remove(path.c_str());
+
+  {
+    Persistent_heap heap = Persistent_heap::open(path.c_str(), 1 << 20);
+    REQUIRE(heap);
+    REQUIRE(heap.root<Entry>() == nullptr);
+
+    Unique_persistent_ptr<Entry> head;
+    for (int i = 0; i < 10; ++i) {
+      head = make_unique_persistent<Entry>(heap, i, std::move(head));
+    }
+    REQUIRE(heap.publish(head));
+    REQUIRE(head == nullptr);
+  }
+
+  std::size_t free_bytes;
+  {
+    // Comes back at whatever address it is mapped at
+    Persistent_heap heap = Persistent_heap::open(path.c_str(), 0);
+    REQUIRE(heap);
+    int expected = 9;
+    for (Entry *e = heap.root<Entry>(); e != nullptr; e = e->next.get().get()) {
+      REQUIRE(e->key == expected);
+      --expected;
+    }
+    REQUIRE(expected == -1);
+
+    // Replacing the root hands back the previous one
+    auto root = make_unique_persistent<Entry>(heap, 42, nullptr);
+    REQUIRE(heap.publish(root));
+    REQUIRE(root != nullptr);
+    REQUIRE(root->key == 9);
+    root.reset();
+    free_bytes = heap.heap().free_bytes();
+  }
+
+  {
+    Persistent_heap heap = Persistent_heap::open(path.c_str(), 0);
+    REQUIRE(heap);
+    REQUIRE(heap.root<Entry>()->key == 42);
+    REQUIRE(heap.root<Entry>()->next == nullptr);
+    REQUIRE(heap.heap().free_bytes() == free_bytes);
+  }
+  std::remove(path.c_str());
+
+  // Not a heap
+  std::FILE *file = std::fopen(path.c_str(), "w");
+  std::fputs("not a heap", file);
+  std::fclose(file);
+  REQUIRE(!Persistent_heap::open(path.c_str(), 1 << 20));
+  std::remove(path.c_str());
+
+  // Zeros are not a heap either, and are left alone
+  const std::string zeros(1 << 16, '\0');
+  file = std::fopen(path.c_str(), "w");
+  std::fwrite(zeros.data(), 1, zeros.size(), file);
+  std::fclose(file);
+  REQUIRE(!Persistent_heap::open(path.c_str(), 1 << 20));
+  REQUIRE(read_file(path) == zeros);
+  std::remove(path.c_str());
+
+  // Formatting was interrupted right after the file was marked
+  const std::uint64_t marker[2] = {Persistent_heap::formatting, 0};
+  file = std::fopen(path.c_str(), "w");
+  std::fwrite(marker, sizeof(marker), 1, file);
+  std::fclose(file);
+  {
+    Persistent_heap heap = Persistent_heap::open(path.c_str(), 1 << 20);
+    REQUIRE(heap);
+    REQUIRE(heap.root<Entry>() == nullptr);
+  }
+  REQUIRE(Persistent_heap::open(path.c_str(), 0));
+  std::remove(path.c_str());
+}
+
+TEST_CASE("Persistent heap is opened once"
+          "[persistent.heap]")
+{
+  const std::string path = heap_path();
+  std::remove(path.c_str());
+
+  {
+    Persistent_heap heap = Persistent_heap::open(path.c_str(), 1 << 20);
+    REQUIRE(heap);
+    REQUIRE(!Persistent_heap::open(path.c_str(), 0));
+
+    // Moving keeps the file locked
+    Persistent_heap moved = std::move(heap);
+    REQUIRE(moved);
+    REQUIRE(!Persistent_heap::open(path.c_str(), 0));
+  }
+  REQUIRE(Persistent_heap::open(path.c_str(), 0));
+  std::remove(path.c_str());
+}
+
+TEST_CASE("Persistent heap after a crash"
+          "[persistent.heap]")
+{
+  const std::string path = heap_path();
+  std::remove(path.c_str());
+
+  const pid_t child = ::fork();
+  REQUIRE(child != -1);
+  if (child == 0) {
+    Persistent_heap heap = Persistent_heap::open(path.c_str(), 1 << 20);
+    auto root = make_unique_persistent<Entry>(heap, 1, nullptr);
+    const bool published = heap.publish(root);
+    // Allocates after publishing and exits without closing the heap
+    auto unpublished = make_unique_persistent<Entry>(heap, 2, nullptr);
+    unpublished.release();
+    ::_exit(published ? 0 : 1);
+  }
+  int status = 0;
+  REQUIRE(::waitpid(child, &status, 0) == child);
+  REQUIRE(WIFEXITED(status));
+  REQUIRE(WEXITSTATUS(status) == 0);
+
+  const std::string crashed = read_file(path);
+  {
+    Persistent_heap heap = Persistent_heap::open(path.c_str(), 0);
+    REQUIRE(heap);
+    REQUIRE(heap.recovered());
+    REQUIRE(heap.root<Entry>()->key == 1);
+    REQUIRE(make_unique_persistent<Entry>(heap, 3, nullptr) == nullptr);
+    Unique_persistent_ptr<Entry> root;
+    REQUIRE(!heap.publish(root));
+
+    // Freeing only touches the private copy
+    root = Unique_persistent_ptr<Entry>(heap.root<Entry>(),
+                                        Segment_delete<Entry>(heap.heap()));
+    root.reset();
+  }
+  REQUIRE(read_file(path) == crashed);
+
+  // Stays recovered until it is replaced
+  Persistent_heap heap = Persistent_heap::open(path.c_str(), 0);
+  REQUIRE(heap.recovered());
+  REQUIRE(heap.root<Entry>()->key == 1);
+  std::remove(path.c_str());
+}
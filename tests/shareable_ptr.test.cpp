@@ -0,0 +1,54 @@
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <memory>
+
+#include "shareable_ptr.h"
+
+namespace
+{
+
+int destroyed = 0;
+
+struct alignas(64) Widget {
+  explicit Widget(int value) : value(value) {}
+  ~Widget()
+  {
+    ++destroyed;
+  }
+
+  int value;
+};
+
+} // namespace
+
+TEST_CASE("Shareable pointer"
+          "[shareable.ptr]")
+{
+  destroyed = 0;
+
+  auto up = make_unique_shareable<Widget>(1);
+  REQUIRE(sizeof(up) == sizeof(Widget *));
+  REQUIRE(reinterpret_cast<std::uintptr_t>(up.get()) % 64 == 0);
+  Widget *raw = up.get();
+
+  std::shared_ptr<Widget> sp = share(std::move(up));
+  REQUIRE(up == nullptr);
+  REQUIRE(sp.get() == raw);
+  REQUIRE(sp.use_count() == 1);
+
+  // The object dies with the last owner, the block with the last observer
+  std::weak_ptr<Widget> weak = sp;
+  std::shared_ptr<Widget> copy = sp;
+  sp.reset();
+  REQUIRE(copy->value == 1);
+  copy.reset();
+  REQUIRE(destroyed == 1);
+  REQUIRE(weak.expired());
+  weak.reset();
+
+  // Not shared, it's an ordinary owner
+  make_unique_shareable<Widget>(2).reset();
+  REQUIRE(destroyed == 2);
+  REQUIRE(share(Unique_shareable_ptr<Widget>()) == nullptr);
+}
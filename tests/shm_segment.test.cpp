@@ -0,0 +1,133 @@
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <string>
+
+#include <unistd.h>
+
+#include "shm_segment.h"
+
+namespace
+{
+
+struct Node {
+  explicit Node(int v) : value(v) {}
+
+  int value;
+  Unique_shm_ptr<Node> next;
+};
+
+std::string segment_name()
+{
+  return "/unique_ptr_test_" + std::to_string(::getpid());
+}
+
+} // namespace
+
+TEST_CASE("Offset pointer"
+          "[offset.ptr]")
+{
+  int values[2] = {1, 2};
+
+  Offset_ptr<int> p;
+  REQUIRE(p == nullptr);
+  REQUIRE(!p);
+  REQUIRE(p.get() == nullptr);
+
+  p = &values[0];
+  REQUIRE(p != nullptr);
+  REQUIRE(*p == 1);
+
+  // Copies point at the same object from a different address
+  Offset_ptr<int> copies[2] = {p, &values[1]};
+  REQUIRE(copies[0] == p);
+  REQUIRE(copies[0].get() == &values[0]);
+  REQUIRE(copies[0] < copies[1]);
+
+  p = nullptr;
+  REQUIRE(p == nullptr);
+
+  Offset_ptr<const int> c = copies[1];
+  REQUIRE(*c == 2);
+}
+
+TEST_CASE("Segment heap"
+          "[segment.heap]")
+{
+  alignas(Segment_heap::alignment) std::byte memory[4096];
+  REQUIRE(!Segment_heap::format(memory, 16));
+  REQUIRE(!Segment_heap::attach(memory));
+
+  Segment_heap heap = Segment_heap::format(memory, sizeof(memory));
+  REQUIRE(heap);
+  REQUIRE(Segment_heap::attach(memory).header() == heap.header());
+  const std::size_t initial = heap.free_bytes();
+
+  void *a = heap.allocate(100);
+  void *b = heap.allocate(200);
+  void *c = heap.allocate(300);
+  REQUIRE(a != nullptr);
+  REQUIRE(reinterpret_cast<std::uintptr_t>(b) % Segment_heap::alignment == 0);
+  REQUIRE(heap.allocate(sizeof(memory)) == nullptr);
+
+  // Freed blocks are merged in any order
+  heap.deallocate(b);
+  heap.deallocate(a);
+  REQUIRE(heap.allocate(250) == a);
+  heap.deallocate(a);
+  heap.deallocate(c);
+  REQUIRE(heap.free_bytes() == initial);
+
+  auto up = make_unique_segment<Node>(heap, 1);
+  REQUIRE(up != nullptr);
+  REQUIRE(up->value == 1);
+  up.reset();
+  REQUIRE(heap.free_bytes() == initial);
+
+  auto huge = make_unique_segment<std::array<char, 8192>>(heap);
+  REQUIRE(huge == nullptr);
+}
+
+TEST_CASE("Shared memory segment"
+          "[shm.segment]")
+{
+  const std::string name = segment_name();
+  Shm_segment segment = Shm_segment::create(name.c_str(), 1 << 20);
+  REQUIRE(segment);
+  REQUIRE(!Shm_segment::create(name.c_str(), 1 << 20));
+  const std::size_t initial = segment.heap().free_bytes();
+
+  {
+    auto head = make_unique_shm<Node>(segment, 0);
+    Node *tail = head.get().get();
+    for (int i = 1; i < 100; ++i) {
+      tail->next = make_unique_shm<Node>(segment, i);
+      tail = tail->next.get().get();
+    }
+    segment.set_root(head.release().get());
+  }
+
+  // A second mapping is at another address, as in another process
+  Shm_segment other = Shm_segment::open(name.c_str());
+  REQUIRE(other);
+  REQUIRE(other.heap().header() != segment.heap().header());
+  REQUIRE(Shm_segment::remove(name.c_str()));
+
+  Unique_shm_ptr<Node> head(other.root<Node>(),
+                            Shm_delete<Node>(other.heap()));
+  int sum = 0;
+  int count = 0;
+  for (Node *n = head.get().get(); n != nullptr; n = n->next.get().get()) {
+    REQUIRE(n->value == count);
+    sum += n->value;
+    ++count;
+  }
+  REQUIRE(count == 100);
+  REQUIRE(sum == 4950);
+
+  // Freed through the second mapping, seen through the first
+  other.set_root(nullptr);
+  head.reset();
+  REQUIRE(segment.root<Node>() == nullptr);
+  REQUIRE(segment.heap().free_bytes() == initial);
+}
@@ -0,0 +1,58 @@
+#include <catch2/catch.hpp>
+
+#include <string>
+
+#include "slot_map.h"
+
+TEST_CASE("Slot map"
+          "[slot.map]")
+{
+  Slot_map<std::string> map;
+  REQUIRE(map.empty());
+
+  Unique_slot<std::string> a = map.emplace("a");
+  Unique_slot<std::string> b = map.emplace(3, 'b');
+  Unique_slot<std::string> c = map.emplace("c");
+  REQUIRE(map.size() == 3);
+  REQUIRE(*a == "a");
+  REQUIRE(b->size() == 3);
+
+  // Weak handles see the value go away
+  Slot_handle<std::string> weak = a.get();
+  REQUIRE(!weak.expired());
+  REQUIRE(weak.get() == &*a);
+
+  // The last value fills the gap
+  a.reset();
+  REQUIRE(weak.expired());
+  REQUIRE(weak.get() == nullptr);
+  REQUIRE(map.size() == 2);
+  REQUIRE(map.values()[0] == "c");
+  REQUIRE(*c == "c");
+  REQUIRE(*b == "bbb");
+
+  // The slot is reused with a new generation
+  Unique_slot<std::string> d = map.emplace("d");
+  REQUIRE(d.get().index() == weak.index());
+  REQUIRE(d.get().generation() != weak.generation());
+  REQUIRE(weak.expired());
+  REQUIRE(*d == "d");
+
+  // Owners are move-only and free their slot once
+  Unique_slot<std::string> moved = std::move(b);
+  REQUIRE(b == nullptr);
+  REQUIRE(*moved == "bbb");
+  moved = nullptr;
+  REQUIRE(map.size() == 2);
+
+  std::string all;
+  for (const std::string &s : map) {
+    all += s;
+  }
+  REQUIRE(all.size() == 2);
+
+  c.reset();
+  d.reset();
+  REQUIRE(map.empty());
+  REQUIRE(Slot_handle<std::string>().expired());
+}
@@ -0,0 +1,137 @@
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <chrono>
+#include <string>
+
+#include <unistd.h>
+
+#include "spillable_ptr.h"
+
+namespace
+{
+
+using Block = std::array<int, 256>;
+
+Unique_ptr<Block> make_block(int value)
+{
+  auto block = make_unique<Block>();
+  block->fill(value);
+  return block;
+}
+
+std::string spill_path()
+{
+  return "spillable_test_" + std::to_string(::getpid()) + ".spill";
+}
+
+} // namespace
+
+template <>
+struct Spill_traits<std::string> {
+  static bool save(const std::string &value, Unique_buffer &out) noexcept
+  {
+    out.clear();
+    return out.append(value.data(), value.size());
+  }
+
+  static Unique_ptr<std::string> load(std::span<const std::byte> data)
+  {
+    return make_unique<std::string>(
+        reinterpret_cast<const char *>(data.data()), data.size());
+  }
+};
+
+TEST_CASE("Spillable pointer"
+          "[spillable.ptr]")
+{
+  Spill_policy policy;
+  policy.max_resident_bytes = 2 * sizeof(Block);
+  policy.max_idle = std::chrono::seconds(10);
+  Spill_store store(spill_path().c_str(), policy);
+  REQUIRE(store);
+
+  Spillable_ptr a(store, make_block(1));
+  Spillable_ptr b(store, make_block(2));
+  REQUIRE(store.resident_bytes() == 2 * sizeof(Block));
+
+  // Over the cap: the coldest is written out
+  Spillable_ptr c(store, make_block(3));
+  REQUIRE(!a.resident());
+  REQUIRE(store.resident_bytes() == 2 * sizeof(Block));
+  REQUIRE(store.file_bytes() == sizeof(Block));
+
+  // And read back on access, which pushes out the next coldest
+  REQUIRE((*a)[255] == 1);
+  REQUIRE(a.resident());
+  REQUIRE(!b.resident());
+  REQUIRE(b->front() == 2);
+  REQUIRE(!c.resident());
+
+  // Respilling reuses the value's region
+  REQUIRE(a.spill());
+  REQUIRE(store.file_bytes() == 3 * sizeof(Block));
+  REQUIRE(store.resident_bytes() == sizeof(Block));
+
+  // Idle values go after max_idle
+  const auto now = Spill_store::clock::now();
+  REQUIRE(store.spill_idle(now) == 0);
+  REQUIRE(store.spill_idle(now + std::chrono::seconds(11)) == sizeof(Block));
+  REQUIRE(store.resident_bytes() == 0);
+  REQUIRE(*c.get() == *make_block(3));
+
+  // Moving keeps the value and its place
+  Spillable_ptr moved = std::move(c);
+  REQUIRE(moved.resident());
+  REQUIRE(store.spill(1) == sizeof(Block));
+  REQUIRE(!moved.resident());
+  REQUIRE((*moved)[0] == 3);
+}
+
+TEST_CASE("Spillable pointer reuses freed regions"
+          "[spillable.ptr]")
+{
+  Spill_store store(spill_path().c_str());
+  REQUIRE(store);
+
+  {
+    Spillable_ptr a(store, make_block(1));
+    Spillable_ptr b(store, make_block(2));
+    REQUIRE(a.spill());
+    REQUIRE(b.spill());
+  }
+  REQUIRE(store.file_bytes() == 2 * sizeof(Block));
+
+  // Both regions were freed and are filled again before the file grows
+  Spillable_ptr c(store, make_block(3));
+  Spillable_ptr d(store, make_block(4));
+  Spillable_ptr e(store, make_block(5));
+  REQUIRE(c.spill());
+  REQUIRE(d.spill());
+  REQUIRE(store.file_bytes() == 2 * sizeof(Block));
+  REQUIRE(e.spill());
+  REQUIRE(store.file_bytes() == 3 * sizeof(Block));
+  REQUIRE((*c)[0] == 3);
+  REQUIRE((*d)[0] == 4);
+}
+
+TEST_CASE("Spillable pointer with Spill_traits"
+          "[spillable.ptr]")
+{
+  Spill_store store(spill_path().c_str(), Spill_policy{});
+  REQUIRE(store);
+
+  Spillable_ptr s(store, make_unique<std::string>("short"), 64);
+  REQUIRE(s.spill());
+  REQUIRE(*s == "short");
+
+  // A larger value moves to a new region, the old one is reused
+  s->assign(100, 'x');
+  REQUIRE(s.spill());
+  REQUIRE(store.file_bytes() == 105);
+  Spillable_ptr t(store, make_unique<std::string>("tiny"), 64);
+  REQUIRE(t.spill());
+  REQUIRE(store.file_bytes() == 105);
+  REQUIRE(*t == "tiny");
+  REQUIRE(s->size() == 100);
+}
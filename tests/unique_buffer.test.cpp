@@ -0,0 +1,85 @@
+#include <catch2/catch.hpp>
+
+#include <limits>
+#include <vector>
+
+#include "unique_buffer.h"
+
+TEST_CASE("Unique buffer"
+          "[unique.buffer]")
+{
+  Unique_buffer buf;
+  REQUIRE(buf.empty());
+  REQUIRE(buf.data() == nullptr);
+
+  const char hello[] = "hello";
+  REQUIRE(buf.append(hello, 5));
+  REQUIRE(buf.size() == 5);
+  REQUIRE(buf.capacity() >= 5);
+  REQUIRE(std::memcmp(buf.data(), "hello", 5) == 0);
+
+  REQUIRE(buf.reserve(100));
+  REQUIRE(buf.capacity() >= 100);
+  REQUIRE(buf.size() == 5);
+
+  Unique_buffer moved(std::move(buf));
+  REQUIRE(buf.size() == 0);
+  REQUIRE(buf.capacity() == 0);
+  REQUIRE(std::memcmp(moved.data(), "hello", 5) == 0);
+
+  auto storage = moved.release();
+  REQUIRE(storage != nullptr);
+  REQUIRE(moved.capacity() == 0);
+}
+
+TEST_CASE("Unique buffer growth past the mmap threshold"
+          "[unique.buffer]")
+{
+  Unique_buffer buf;
+  std::vector<char> chunk(64 * 1024);
+
+  // Crosses from realloc to mmap and then grows the mapping
+  for (std::size_t i = 0; buf.size() < 4 * Unique_buffer::mmap_threshold;
+       ++i) {
+    std::fill(chunk.begin(), chunk.end(), static_cast<char>(i));
+    REQUIRE(buf.append(chunk.data(), chunk.size()));
+  }
+
+  for (std::size_t i = 0; i < buf.size() / chunk.size(); ++i) {
+    REQUIRE(buf.data()[i * chunk.size()] == static_cast<std::byte>(i));
+    REQUIRE(buf.data()[(i + 1) * chunk.size() - 1] ==
+            static_cast<std::byte>(i));
+  }
+
+  REQUIRE(buf.resize(10));
+  REQUIRE(buf.size() == 10);
+  buf.clear();
+  REQUIRE(buf.empty());
+}
+
+TEST_CASE("Unique buffer reuse after releasing a mapping"
+          "[unique.buffer]")
+{
+  Unique_buffer buf;
+  REQUIRE(buf.reserve(Unique_buffer::mmap_threshold));
+  auto mapping = buf.release();
+  REQUIRE(mapping.get_deleter().mapped() != 0);
+
+  // The next storage is from malloc again and is freed as such
+  REQUIRE(buf.append("abc", 3));
+  REQUIRE(buf.capacity() < Unique_buffer::mmap_threshold);
+  REQUIRE(buf.release().get_deleter().mapped() == 0);
+
+  Unique_buffer mapped;
+  REQUIRE(mapped.reserve(Unique_buffer::mmap_threshold));
+  Unique_buffer moved = std::move(mapped);
+  REQUIRE(mapped.append("abc", 3));
+  REQUIRE(mapped.release().get_deleter().mapped() == 0);
+  moved = std::move(mapped);
+  REQUIRE(moved.capacity() == 0);
+
+  // Sizes that would overflow fail instead of wrapping around
+  REQUIRE(buf.append("abc", 3));
+  REQUIRE(!buf.append("abc", std::numeric_limits<std::size_t>::max()));
+  REQUIRE(buf.size() == 3);
+}
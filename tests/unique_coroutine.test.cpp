@@ -0,0 +1,141 @@
+#include <catch2/catch.hpp>
+
+#include <coroutine>
+
+#include "unique_coroutine.h"
+
+namespace
+{
+
+int alive = 0;
+
+struct Counted {
+  Counted()
+  {
+    ++alive;
+  }
+  ~Counted()
+  {
+    --alive;
+  }
+};
+
+// Yields values, suspended at the start and at the end
+template <typename Base>
+struct Generator {
+  struct promise_type : Base {
+    int value = 0;
+
+    Unique_coroutine<promise_type> get_return_object() noexcept
+    {
+      return adopt_coroutine(*this);
+    }
+    std::suspend_always initial_suspend() noexcept
+    {
+      return {};
+    }
+    std::suspend_always final_suspend() noexcept
+    {
+      return {};
+    }
+    std::suspend_always yield_value(int v) noexcept
+    {
+      value = v;
+      return {};
+    }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept {}
+  };
+
+  Generator(Unique_coroutine<promise_type> coroutine) noexcept
+      : coroutine(std::move(coroutine))
+  {
+  }
+
+  int next()
+  {
+    coroutine.get().resume();
+    return coroutine.get().promise().value;
+  }
+
+  Unique_coroutine<promise_type> coroutine;
+};
+
+struct Heap_frame {
+};
+
+Generator<Heap_frame> count(int n)
+{
+  Counted counted;
+  for (int i = 1; i <= n; ++i) {
+    co_yield i;
+  }
+}
+
+Generator<Pooled_frame> pooled_count(int n)
+{
+  Counted counted;
+  for (int i = 1; i <= n; ++i) {
+    co_yield i;
+  }
+}
+
+} // namespace
+
+TEST_CASE("Unique coroutine"
+          "[unique.coroutine]")
+{
+  alive = 0;
+  REQUIRE(sizeof(Unique_coroutine<Generator<Heap_frame>::promise_type>) ==
+          sizeof(std::coroutine_handle<>));
+
+  {
+    auto gen = count(3);
+    REQUIRE(gen.next() == 1);
+    REQUIRE(gen.next() == 2);
+    REQUIRE(alive == 1);
+
+    // Moving transfers the frame
+    auto moved = std::move(gen.coroutine);
+    REQUIRE(gen.coroutine == nullptr);
+    moved.get().resume();
+    REQUIRE(moved.get().promise().value == 3);
+  }
+  // Destroyed while suspended in the middle
+  REQUIRE(alive == 0);
+
+  auto gen = count(1);
+  gen.next();
+  gen.next();
+  REQUIRE(gen.coroutine.get().done());
+  gen.coroutine.reset();
+  REQUIRE(alive == 0);
+}
+
+TEST_CASE("Pooled coroutine frames"
+          "[unique.coroutine]")
+{
+  Frame_pool &pool = Frame_pool::this_thread();
+
+  auto first = pooled_count(2);
+  const auto address = first.coroutine.get().address();
+  REQUIRE(first.next() == 1);
+  first.coroutine.reset();
+
+  // The frame is cached and handed out again
+  std::size_t cached = 0;
+  for (std::size_t size = 1; size <= Frame_pool::max_size;
+       size += Frame_pool::granularity) {
+    cached += pool.cached(size);
+  }
+  REQUIRE(cached >= 1);
+  auto second = pooled_count(2);
+  REQUIRE(second.coroutine.get().address() == address);
+  REQUIRE(second.next() == 1);
+
+  // Sizes beyond the classes bypass the pool
+  void *big = pool.allocate(Frame_pool::max_size + 1);
+  pool.deallocate(big, Frame_pool::max_size + 1);
+  REQUIRE(Frame_pool::size_class(Frame_pool::granularity) == 0);
+  REQUIRE(Frame_pool::size_class(Frame_pool::granularity + 1) == 1);
+}
@@ -0,0 +1,103 @@
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <string>
+
+#include "unique_function.h"
+
+namespace
+{
+
+int moves = 0;
+int destroyed = 0;
+
+// Owns through a pointer, so copying its bytes relocates it
+struct Relocatable {
+  Relocatable() = default;
+  Relocatable(Relocatable &&other) noexcept : value(std::move(other.value))
+  {
+    ++moves;
+  }
+  ~Relocatable()
+  {
+    if (value != nullptr) {
+      ++destroyed;
+    }
+  }
+
+  int operator()(int x)
+  {
+    return *value + x;
+  }
+
+  Unique_ptr<int> value = make_unique<int>(1);
+};
+
+int twice(int x)
+{
+  return 2 * x;
+}
+
+} // namespace
+
+template <>
+struct Is_trivially_relocatable<Relocatable> : std::true_type {
+};
+
+TEST_CASE("Unique function"
+          "[unique.function]")
+{
+  Unique_function<int(int)> empty;
+  REQUIRE(empty == nullptr);
+  REQUIRE(!Unique_function<int(int)>(static_cast<int (*)(int)>(nullptr)));
+
+  Unique_function<int(int)> f = twice;
+  REQUIRE(f(3) == 6);
+
+  // Move-only captures are stored in place
+  Unique_function<int(int)> g = [p = make_unique<int>(10)](int x) {
+    return *p + x;
+  };
+  REQUIRE(g(1) == 11);
+  Unique_function<int(int)> h = std::move(g);
+  REQUIRE(!g);
+  REQUIRE(h(2) == 12);
+
+  // Too large for the buffer, moved as a pointer
+  std::array<int, 64> big{};
+  big[63] = 5;
+  Unique_function<int(int)> boxed = [big, p = make_unique<int>(1)](int x) {
+    return big[63] + *p + x;
+  };
+  boxed = std::move(h);
+  REQUIRE(boxed(0) == 10);
+
+  Unique_function<std::string(std::string &&, const std::string &)> concat =
+      [](std::string &&a, const std::string &b) { return a + b; };
+  REQUIRE(concat("a", "b") == "ab");
+
+  Unique_function<void()> nothing = [] {};
+  nothing();
+  nothing = nullptr;
+  REQUIRE(!nothing);
+}
+
+TEST_CASE("Unique function relocation"
+          "[unique.function]")
+{
+  moves = 0;
+  destroyed = 0;
+  {
+    Unique_function<int(int)> f = Relocatable();
+    const int stored = moves;
+    Unique_function<int(int)> g = std::move(f);
+    Unique_function<int(int)> h = std::move(g);
+    // Relocated by copying bytes, without a move or a destroy
+    REQUIRE(moves == stored);
+    REQUIRE(h(1) == 2);
+    REQUIRE(destroyed == 0);
+  }
+  REQUIRE(destroyed == 1);
+  REQUIRE(Is_trivially_relocatable<Unique_ptr<int>>::value);
+  REQUIRE(!Is_trivially_relocatable<std::string>::value);
+}
@@ -234,6 +234,9 @@ TEST_CASE("Creation"
 {
   Unique_ptr<int> up = make_unique<int>(42);
   REQUIRE(*up == 42);
+
+  Unique_ptr<int> up2 = make_unique_nothrow<int>(43);
+  REQUIRE(*up2 == 43);
 }
 
 TEST_CASE("Specialized algorithms"
@@ -0,0 +1,46 @@
+#include <catch2/catch.hpp>
+
+#include "unique_ptr_fwd.h"
+
+struct Widget;
+
+// Declarations only need the forward declarations
+Unique_ptr<Widget> make_widget(int value);
+int widget_value(const Unique_ptr<Widget> &w);
+
+#include "unique_ptr_instantiations.h"
+
+struct Widget {
+  int value;
+};
+
+Unique_ptr<Widget> make_widget(int value)
+{
+  return make_unique<Widget>(value);
+}
+
+int widget_value(const Unique_ptr<Widget> &w)
+{
+  return w->value;
+}
+
+TEST_CASE("Forward declarations"
+          "[unique.ptr.fwd]")
+{
+  REQUIRE(std::is_same_v<Unique_ptr<Widget>,
+                         Unique_ptr<Widget, Default_delete<Widget>>>);
+  REQUIRE(widget_value(make_widget(42)) == 42);
+}
+
+TEST_CASE("Explicit instantiations"
+          "[unique.ptr.fwd]")
+{
+  Unique_ptr<int> up1 = make_unique<int>(1);
+  Unique_ptr<int> up2;
+  up2 = std::move(up1);
+  REQUIRE(up1 == nullptr);
+  REQUIRE(*up2 == 1);
+  const Unique_ptr<double> up3 = make_unique<double>(2.0);
+  REQUIRE(std::is_same_v<decltype(up3.get_deleter()),
+                         const Default_delete<double> &>);
+}
@@ -0,0 +1,13 @@
+#include <compare>
+
+import unique_ptr;
+
+int main()
+{
+  auto p = make_unique<int>(4);
+  auto q = make_unique<int>(2);
+
+  if (*p != 4 || p == q || p == nullptr) {
+    return 1;
+  }
+}
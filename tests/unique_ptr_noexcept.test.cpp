@@ -0,0 +1,81 @@
+#include <cstddef>
+#include <limits>
+
+#include "any_delete.h"
+#include "delete_chain.h"
+#include "discardable_ptr.h"
+#include "erased_delete.h"
+#include "flat_layout.h"
+#include "flat_serialize.h"
+#include "frozen.h"
+#include "io_buffer_pool.h"
+#include "lru_cache.h"
+#include "lru_list.h"
+#include "make_unique_group.h"
+#include "make_unique_trailing.h"
+#include "observable_ptr.h"
+#include "offset_ptr.h"
+#include "out_ptr.h"
+#include "persistent_heap.h"
+#include "prefixed_layout.h"
+#include "segment_heap.h"
+#include "shareable_ptr.h"
+#include "shm_segment.h"
+#include "slot_map.h"
+#include "spillable_ptr.h"
+#include "unique_buffer.h"
+#include "unique_coroutine.h"
+#include "unique_function.h"
+#include "unique_ptr.h"
+#include "unique_ptr_fwd.h"
+#include "unique_ptr_instantiations.h"
+
+// Built with -fno-exceptions: every header in include/ must compile without
+// exceptions and the nothrow factories report allocation failure with an
+// empty owner.
+
+struct S {
+  int value = 4;
+};
+
+// Allocation always fails
+struct Huge {
+  char data[std::numeric_limits<std::ptrdiff_t>::max() / 2];
+};
+
+int main()
+{
+  auto up1 = make_unique_nothrow<S>();
+  auto up2 = make_unique_for_overwrite_nothrow<S>();
+  if (up1 == nullptr || up1->value != 4 || up2 == nullptr) {
+    return 1;
+  }
+
+  auto up3 = make_unique_nothrow<Huge>();
+  if (up3 != nullptr) {
+    return 2;
+  }
+
+  auto up4 = make_unique_trailing_nothrow<S, int>(4);
+  if (up4 == nullptr || trailing(up4).size() != 4) {
+    return 3;
+  }
+
+  auto up5 = make_unique_trailing_nothrow<S, Huge>(2);
+  if (up5 != nullptr) {
+    return 4;
+  }
+
+  // A count whose block size would overflow
+  auto up10 = make_unique_trailing_nothrow<S, int>(
+      std::numeric_limits<std::size_t>::max() / 2);
+  if (up10 != nullptr) {
+    return 6;
+  }
+
+  Unique_ptr<void, Any_delete> up6 = std::move(up1);
+  Unique_ptr<S, Erased_delete<S>> up7 = std::move(up2);
+  Unique_ptr<S, Delete_chain<Default_delete<S>>> up8(new S);
+  auto up9 = make_unique_group<S>();
+  return up6 && up7 && up8 && up9 ? 0 : 5;
+}